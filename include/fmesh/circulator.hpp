@@ -0,0 +1,258 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_CIRCULATOR_HPP
+#define FMESH_CIRCULATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+
+#include "fmesh/index.hpp"
+#include "fmesh/iterator_range.hpp"
+
+namespace fmesh {
+
+/// @brief Iterator over an index list which skips invalid mesh entities
+template <typename Mesh, typename Index>
+class valid_index_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Index;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Index*;
+  using reference = const Index&;
+
+  valid_index_iterator() = default;
+  valid_index_iterator(const Mesh* mesh, const Index* it, const Index* last)
+      : mesh_{mesh}, it_{it}, last_{last} {
+    this->skip();
+  }
+
+  valid_index_iterator& operator++() noexcept {
+    ++it_;
+    this->skip();
+    return *this;
+  }
+  valid_index_iterator operator++(int) noexcept {
+    valid_index_iterator tmp{*this};
+    ++(*this);
+    return tmp;
+  }
+
+  reference operator*() const noexcept { return *it_; }
+  pointer operator->() const noexcept { return it_; }
+
+  friend bool operator==(const valid_index_iterator& it1,
+                         const valid_index_iterator& it2) noexcept {
+    return it1.it_ == it2.it_;
+  }
+  friend bool operator!=(const valid_index_iterator& it1,
+                         const valid_index_iterator& it2) noexcept {
+    return !(it1 == it2);
+  }
+
+ private:
+  void skip() noexcept {
+    while (it_ != last_ && !mesh_->is_valid(*it_)) ++it_;
+  }
+
+  const Mesh* mesh_ = nullptr;
+  const Index* it_ = nullptr;
+  const Index* last_ = nullptr;
+};
+
+/// @brief Iterator over vertices connected to a vertex by valid edges
+template <typename Mesh>
+class vertex_vertex_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = vertex_index;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = vertex_index;
+
+  vertex_vertex_iterator() = default;
+  vertex_vertex_iterator(const Mesh* mesh, vertex_index center,
+                         const edge_index* it, const edge_index* last)
+      : mesh_{mesh}, center_{center}, it_{mesh, it, last} {}
+
+  vertex_vertex_iterator& operator++() noexcept {
+    ++it_;
+    return *this;
+  }
+  vertex_vertex_iterator operator++(int) noexcept {
+    vertex_vertex_iterator tmp{*this};
+    ++it_;
+    return tmp;
+  }
+
+  /// @brief Returns the other end of the current edge
+  reference operator*() const noexcept {
+    const auto& e = mesh_->edge(*it_);
+    return e.first == center_ ? e.second : e.first;
+  }
+
+  friend bool operator==(const vertex_vertex_iterator& it1,
+                         const vertex_vertex_iterator& it2) noexcept {
+    return it1.it_ == it2.it_;
+  }
+  friend bool operator!=(const vertex_vertex_iterator& it1,
+                         const vertex_vertex_iterator& it2) noexcept {
+    return !(it1 == it2);
+  }
+
+ private:
+  const Mesh* mesh_ = nullptr;
+  vertex_index center_;
+  valid_index_iterator<Mesh, edge_index> it_;
+};
+
+/// @brief Iterator over faces sharing valid edges with a face
+///
+/// Every other valid face at a branching edge is visited.
+template <typename Mesh>
+class face_face_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = face_index;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const face_index*;
+  using reference = const face_index&;
+
+  face_face_iterator() = default;
+  face_face_iterator(const Mesh* mesh, face_index center,
+                     const edge_index* edge, const edge_index* edge_last)
+      : mesh_{mesh}, center_{center}, edge_{edge}, edge_last_{edge_last} {
+    this->load();
+    this->skip();
+  }
+
+  face_face_iterator& operator++() noexcept {
+    ++face_;
+    this->skip();
+    return *this;
+  }
+  face_face_iterator operator++(int) noexcept {
+    face_face_iterator tmp{*this};
+    ++(*this);
+    return tmp;
+  }
+
+  reference operator*() const noexcept { return *face_; }
+  pointer operator->() const noexcept { return face_; }
+
+  friend bool operator==(const face_face_iterator& it1,
+                         const face_face_iterator& it2) noexcept {
+    return it1.edge_ == it2.edge_ && it1.face_ == it2.face_;
+  }
+  friend bool operator!=(const face_face_iterator& it1,
+                         const face_face_iterator& it2) noexcept {
+    return !(it1 == it2);
+  }
+
+ private:
+  /// @brief Loads faces of the current edge
+  void load() noexcept {
+    if (edge_ == edge_last_) {
+      face_ = face_last_ = nullptr;
+      return;
+    }
+    const auto fs = mesh_->edge_faces(*edge_);
+    face_ = fs.begin();
+    face_last_ = fs.end();
+  }
+
+  /// @brief Moves to the next valid face other than the center
+  void skip() noexcept {
+    while (edge_ != edge_last_) {
+      for (; face_ != face_last_; ++face_)
+        if (*face_ != center_ && mesh_->is_valid(*face_)) return;
+      ++edge_;
+      this->load();
+    }
+  }
+
+  const Mesh* mesh_ = nullptr;
+  face_index center_;
+  const edge_index* edge_ = nullptr;
+  const edge_index* edge_last_ = nullptr;
+  const face_index* face_ = nullptr;
+  const face_index* face_last_ = nullptr;
+};
+
+namespace detail {
+
+template <typename Mesh, typename Index>
+auto make_valid_range(const Mesh& mesh, iterator_range<const Index*> r) {
+  using iterator = valid_index_iterator<Mesh, Index>;
+  return make_iterator_range(iterator{&mesh, r.begin(), r.end()},
+                             iterator{&mesh, r.end(), r.end()});
+}
+
+}  // namespace detail
+
+/// @name Circulators
+///
+/// Ranges of valid mesh entities around a mesh entity. They refer to the
+/// connectivity of a mesh and are invalidated by adding faces to it.
+/// @{
+
+/// @brief Returns valid faces sharing a vertex
+template <typename Mesh>
+auto faces_around(const Mesh& mesh, vertex_index vi) {
+  return detail::make_valid_range(mesh, mesh.vertex_faces(vi));
+}
+
+/// @brief Returns valid edges sharing a vertex
+template <typename Mesh>
+auto edges_around(const Mesh& mesh, vertex_index vi) {
+  return detail::make_valid_range(mesh, mesh.vertex_edges(vi));
+}
+
+/// @brief Returns valid faces sharing an edge
+template <typename Mesh>
+auto faces_around(const Mesh& mesh, edge_index ei) {
+  return detail::make_valid_range(mesh, mesh.edge_faces(ei));
+}
+
+/// @brief Returns vertices connected to a vertex by valid edges
+template <typename Mesh>
+auto adjacent_vertices(const Mesh& mesh, vertex_index vi) {
+  using iterator = vertex_vertex_iterator<Mesh>;
+  const auto es = mesh.vertex_edges(vi);
+  return make_iterator_range(iterator{&mesh, vi, es.begin(), es.end()},
+                             iterator{&mesh, vi, es.end(), es.end()});
+}
+
+/// @brief Returns valid faces sharing edges with a face
+template <typename Mesh>
+auto adjacent_faces(const Mesh& mesh, face_index fi) {
+  using iterator = face_face_iterator<Mesh>;
+  const auto es = mesh.face_edges(fi);
+  return make_iterator_range(iterator{&mesh, fi, es.begin(), es.end()},
+                             iterator{&mesh, fi, es.end(), es.end()});
+}
+/// @}
+
+}  // namespace fmesh
+
+#endif  // FMESH_CIRCULATOR_HPP
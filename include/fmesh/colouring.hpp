@@ -0,0 +1,292 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_COLOURING_HPP
+#define FMESH_COLOURING_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/iterator_range.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Mesh entities grouped by colours
+///
+/// Entities of the same colour do not conflict with each other, so a loop
+/// over one colour can be run in parallel without atomics. A colouring stays
+/// valid until the topology of the mesh changes.
+template <typename Index>
+struct colouring {
+  /// Offsets of colours in indices. The size is num_colours() + 1.
+  std::vector<std::size_t> colour_offsets;
+  /// Indices sorted by colour, and by index within each colour
+  std::vector<Index> indices;
+
+  std::size_t num_colours() const noexcept {
+    return colour_offsets.empty() ? 0 : colour_offsets.size() - 1;
+  }
+
+  /// @brief Returns entities of the c-th colour
+  auto colour(std::size_t c) const noexcept {
+    const auto first = indices.data();
+    return make_iterator_range(first + colour_offsets[c],
+                               first + colour_offsets[c + 1]);
+  }
+};
+
+/// @brief Entities shared by conflicting faces
+enum class face_conflict {
+  vertex,  ///< Faces sharing a vertex conflict
+  edge,    ///< Faces sharing an edge conflict
+};
+
+/// @brief Colouring algorithms
+enum class colouring_method {
+  /// Colours entities in index order with the smallest free colour
+  greedy,
+  /// Colours independent sets of entities with locally maximal random weights
+  /// in rounds. Each round runs in parallel, and results do not depend on the
+  /// number of threads.
+  jones_plassmann,
+};
+
+namespace detail {
+
+/// @brief Colour of uncoloured entities
+constexpr auto no_colour = std::numeric_limits<std::uint32_t>::max();
+
+/// @brief Deterministic pseudo-random weight of an index (SplitMix64)
+inline std::uint64_t colouring_weight(std::uint64_t i) noexcept {
+  i += 0x9e3779b97f4a7c15ull;
+  i = (i ^ (i >> 30)) * 0xbf58476d1ce4e5b9ull;
+  i = (i ^ (i >> 27)) * 0x94d049bb133111ebull;
+  return i ^ (i >> 31);
+}
+
+/// @brief Colours a conflict graph
+/// @param[in] n The number of entities
+/// @param[in] is_active Function called as `is_active(i)` which returns false
+/// for entities excluded from colouring
+/// @param[in] for_each_neighbor Function called as `for_each_neighbor(i, f)`
+/// which calls `f(j)` for each entity conflicting with i. It may call f(i).
+template <typename Index, typename IsActive, typename ForEachNeighbor>
+colouring<Index> colour_graph(std::size_t n, IsActive&& is_active,
+                              ForEachNeighbor&& for_each_neighbor,
+                              colouring_method method) {
+  std::vector<std::uint32_t> colours(n, no_colour);
+
+  // Stamps of colours used by neighbors of the current entity
+  const auto assign = [&](std::size_t i, std::vector<std::size_t>& used) {
+    for_each_neighbor(Index{i}, [&](Index j) {
+      const auto c = colours[j.get()];
+      if (c == no_colour || j.get() == i) return;
+      if (used.size() <= c) used.resize(c + 1, 0);
+      used[c] = i + 1;
+    });
+    std::uint32_t c = 0;
+    while (c < used.size() && used[c] == i + 1) ++c;
+    colours[i] = c;
+  };
+
+  if (method == colouring_method::greedy) {
+    // Each entity depends on colours of all preceding ones.
+    std::vector<std::size_t> used;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (is_active(Index{i})) assign(i, used);
+    }
+  } else {
+    // Weights are compared with indices to break ties.
+    const auto precedes = [](std::size_t i, std::size_t j) {
+      const auto wi = colouring_weight(i);
+      const auto wj = colouring_weight(j);
+      return wi > wj || (wi == wj && i > j);
+    };
+    std::vector<std::size_t> remaining;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (is_active(Index{i})) remaining.push_back(i);
+    }
+
+    // Rounds are processed in parallel chunks of remaining entities.
+    constexpr std::size_t grain = 1024;
+    std::vector<std::size_t> chunks;
+    const auto for_each_chunk = [&remaining, &chunks](auto&& f) {
+      chunks.resize((remaining.size() + grain - 1) / grain);
+      std::iota(chunks.begin(), chunks.end(), std::size_t{0});
+      parallel_for(
+          chunks,
+          [&](std::size_t c) {
+            f(c * grain, std::min(remaining.size(), (c + 1) * grain));
+          },
+          1);
+    };
+
+    std::vector<char> selected;
+    while (!remaining.empty()) {
+      // Colours are only read while independent sets are selected.
+      selected.assign(remaining.size(), 0);
+      for_each_chunk([&](std::size_t first, std::size_t last) {
+        for (auto k = first; k < last; ++k) {
+          const auto i = remaining[k];
+          bool is_maximal = true;
+          for_each_neighbor(Index{i}, [&](Index j) {
+            if (j.get() != i && colours[j.get()] == no_colour &&
+                is_active(j) && !precedes(i, j.get()))
+              is_maximal = false;
+          });
+          selected[k] = is_maximal;
+        }
+      });
+      // Selected entities are independent, so colours read by assign() are
+      // not written in the same round.
+      for_each_chunk([&](std::size_t first, std::size_t last) {
+        std::vector<std::size_t> used;
+        for (auto k = first; k < last; ++k) {
+          if (selected[k]) assign(remaining[k], used);
+        }
+      });
+      remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                     [&colours](std::size_t i) {
+                                       return colours[i] != no_colour;
+                                     }),
+                      remaining.end());
+    }
+  }
+
+  // Groups entities by colour.
+  colouring<Index> result;
+  std::uint32_t num_colours = 0;
+  for (auto&& c : colours) {
+    if (c != no_colour) num_colours = std::max(num_colours, c + 1);
+  }
+  result.colour_offsets.assign(num_colours + 1, 0);
+  for (auto&& c : colours) {
+    if (c != no_colour) ++result.colour_offsets[c + 1];
+  }
+  for (std::size_t c = 0; c < num_colours; ++c)
+    result.colour_offsets[c + 1] += result.colour_offsets[c];
+  result.indices.resize(result.colour_offsets.back());
+  auto next = result.colour_offsets;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (colours[i] != no_colour) result.indices[next[colours[i]]++] = Index{i};
+  }
+  return result;
+}
+
+}  // namespace detail
+
+/// @brief Colours valid faces so that faces of the same colour do not share
+/// a vertex or an edge
+/// @param[in] mesh Mesh
+/// @param[in] conflict Entities which faces of the same colour must not share
+/// @param[in] method Colouring algorithm
+template <typename Mesh>
+colouring<face_index> colour_faces(
+    const Mesh& mesh, face_conflict conflict = face_conflict::vertex,
+    colouring_method method = colouring_method::greedy) {
+  FMESH_SCOPED_TIMER("fmesh::colour_faces");
+  mesh.build_caches();
+  const auto is_active = [&mesh](face_index fi) { return mesh.is_valid(fi); };
+  if (conflict == face_conflict::vertex) {
+    return detail::colour_graph<face_index>(
+        mesh.num_faces(), is_active,
+        [&mesh](face_index fi, auto&& f) {
+          for (auto&& vi : mesh.face(fi)) {
+            for (auto&& fj : mesh.vertex_faces(vi)) {
+              if (mesh.is_valid(fj)) f(fj);
+            }
+          }
+        },
+        method);
+  }
+  return detail::colour_graph<face_index>(
+      mesh.num_faces(), is_active,
+      [&mesh](face_index fi, auto&& f) {
+        for (auto&& ei : mesh.face_edges(fi)) {
+          for (auto&& fj : mesh.edge_faces(ei)) {
+            if (mesh.is_valid(fj)) f(fj);
+          }
+        }
+      },
+      method);
+}
+
+/// @brief Colours valid edges so that edges of the same colour do not share
+/// a vertex
+/// @param[in] mesh Mesh
+/// @param[in] method Colouring algorithm
+template <typename Mesh>
+colouring<edge_index> colour_edges(
+    const Mesh& mesh, colouring_method method = colouring_method::greedy) {
+  FMESH_SCOPED_TIMER("fmesh::colour_edges");
+  return detail::colour_graph<edge_index>(
+      mesh.num_edges(), [&mesh](edge_index ei) { return mesh.is_valid(ei); },
+      [&mesh](edge_index ei, auto&& f) {
+        const auto& e = mesh.edge(ei);
+        for (auto&& vi : {e.first, e.second}) {
+          for (auto&& ej : mesh.vertex_edges(vi)) {
+            if (mesh.is_valid(ej)) f(ej);
+          }
+        }
+      },
+      method);
+}
+
+/// @brief Adds contributions of entities to values of their keys in parallel
+/// @param[in,out] values Property array
+/// @param[in] colours Colouring of entities. Entities of the same colour must
+/// not share keys, e.g. faces coloured with face_conflict::vertex for keys of
+/// their vertices.
+/// @param[in] keys Function called as `keys(i)` which returns the range of
+/// keys of entity i
+/// @param[in] contributions Function called as `contributions(i)` which
+/// returns the range of values added to each key of entity i
+/// @param[in] grain The number of entities processed by a task
+///
+/// Colours are processed one after another, and entities of each colour by
+/// parallel_for(), so values are written without atomics or locks. Results
+/// do not depend on the number of threads, but may differ in rounding from
+/// adding contributions in index order.
+template <typename Key, typename T, typename Allocator, typename Index,
+          typename Keys, typename Contributions>
+void scatter_add(property_array<Key, T, Allocator>& values,
+                 const colouring<Index>& colours, Keys&& keys,
+                 Contributions&& contributions, std::size_t grain = 0) {
+  FMESH_SCOPED_TIMER("fmesh::scatter_add");
+  for (std::size_t c = 0; c < colours.num_colours(); ++c) {
+    parallel_for(
+        colours.colour(c),
+        [&](Index i) { scatter_add(values, keys(i), contributions(i)); },
+        grain);
+  }
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_COLOURING_HPP
@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_COMPONENTS_HPP
+#define FMESH_COMPONENTS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+#include "fmesh/union_find.hpp"
+
+namespace fmesh {
+
+/// @brief Connected components of faces through shared edges
+///
+/// Faces sharing an edge are connected, including all faces at a branching
+/// edge. Components are tracked by a union-find forest, so faces added to a
+/// mesh can be merged into existing components by update().
+///
+/// New faces are united in parallel. Roots of the forest are the smallest
+/// face indices of components regardless of the order of unions.
+///
+/// Invalidating faces may split components, which requires label() to start
+/// over. Compaction by remove_invalid_entities() renumbers faces and
+/// invalidates the forest as well; update() starts over by itself only if
+/// the mesh has fewer faces than before.
+class face_components {
+ public:
+  /// @brief Label of faces excluded from labelling
+  static constexpr auto invalid_component =
+      std::numeric_limits<std::uint32_t>::max();
+
+  /// @brief Labels all valid faces
+  /// @param[in] mesh Mesh
+  /// @param[out] labels Component id of each face
+  /// @param[in] mask Function called as `mask(fi)` which returns false for
+  /// faces to be ignored, e.g. closed faces
+  /// @return The number of components
+  ///
+  /// Component ids are numbered in the order of the smallest face index in
+  /// each component.
+  template <typename Mesh, typename Mask>
+  std::uint32_t label(const Mesh& mesh, face_property<std::uint32_t>& labels,
+                      Mask&& mask) {
+    parents_.clear();
+    return this->update(mesh, labels, mask);
+  }
+
+  template <typename Mesh>
+  std::uint32_t label(const Mesh& mesh, face_property<std::uint32_t>& labels) {
+    return this->label(mesh, labels, [](face_index) { return true; });
+  }
+
+  /// @brief Merges faces added since the last call into components
+  /// @param[in] mesh Mesh
+  /// @param[out] labels Component id of each face
+  /// @param[in] mask Function called as `mask(fi)` which returns false for
+  /// faces to be ignored. It is only called for faces not labelled before,
+  /// possibly from several threads at once.
+  /// @return The number of components
+  ///
+  /// All faces are labelled again if the mesh has fewer faces than at the
+  /// last call. Compaction that keeps the number of faces cannot be detected,
+  /// so label() must be called after remove_invalid_entities().
+  template <typename Mesh, typename Mask>
+  std::uint32_t update(const Mesh& mesh, face_property<std::uint32_t>& labels,
+                       Mask&& mask) {
+    FMESH_SCOPED_TIMER("fmesh::face_components::update");
+    const auto last = mesh.num_faces();
+    // Faces have been removed.
+    if (last < parents_.size()) parents_.clear();
+    const auto first = parents_.size();
+    parents_.resize(last);
+
+    std::vector<std::size_t> ids(last - first);
+    std::iota(ids.begin(), ids.end(), first);
+    parallel_for(ids, [this, &mesh, &mask](std::size_t i) {
+      const face_index fi{i};
+      parents_.reset(i, mesh.is_valid(fi) && mask(fi) ? i : excluded);
+    });
+    parallel_for(ids, [this, &mesh](std::size_t i) {
+      if (parents_.parent(i) == excluded) return;
+      for (auto&& ei : mesh.face_edges(face_index{i}))
+        for (auto&& fj : mesh.edge_faces(ei))
+          if (parents_.parent(fj.get()) != excluded)
+            parents_.unite(i, fj.get());
+    });
+
+    // Roots are the smallest indices of components, so numbering them in
+    // index order gives the same labels as a serial union-find.
+    std::uint32_t n = 0;
+    labels.resize(last);
+    for (std::size_t i = 0; i < last; ++i) {
+      const face_index fi{i};
+      if (parents_.parent(i) == excluded) {
+        labels[fi] = invalid_component;
+        continue;
+      }
+      const auto root = parents_.find(i);
+      labels[fi] = root == i ? n++ : labels[face_index{root}];
+    }
+    return n;
+  }
+
+  template <typename Mesh>
+  std::uint32_t update(const Mesh& mesh, face_property<std::uint32_t>& labels) {
+    return this->update(mesh, labels, [](face_index) { return true; });
+  }
+
+ private:
+  static constexpr auto excluded = std::numeric_limits<std::size_t>::max();
+
+  detail::atomic_union_find parents_;
+};
+
+}  // namespace fmesh
+
+#endif  // FMESH_COMPONENTS_HPP
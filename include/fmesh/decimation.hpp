@@ -0,0 +1,368 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_DECIMATION_HPP
+#define FMESH_DECIMATION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/iterator_range.hpp"
+#include "fmesh/parallel.hpp"
+
+namespace fmesh {
+
+/// @brief Result of decimate()
+struct decimation_result {
+  /// The number of collapsed edges
+  std::size_t num_collapses = 0;
+  /// The number of independent sets of collapses
+  std::size_t num_batches = 0;
+  /// Maps from indices before decimation to indices after decimation
+  entity_remap remap;
+};
+
+namespace detail {
+
+template <typename Mesh>
+std::size_t count_valid_faces(const Mesh& mesh, edge_index ei) {
+  const auto fs = mesh.edge_faces(ei);
+  return std::count_if(fs.begin(), fs.end(),
+                       [&mesh](auto fi) { return mesh.is_valid(fi); });
+}
+
+/// @brief Checks if every edge around a vertex is shared by exactly two faces
+///
+/// Vertices on boundaries and branching edges are not interior vertices.
+template <typename Mesh>
+bool is_interior_vertex(const Mesh& mesh, vertex_index vi) {
+  bool has_faces = false;
+  for (auto&& fi : mesh.vertex_faces(vi)) {
+    if (!mesh.is_valid(fi)) continue;
+    has_faces = true;
+    for (auto&& ei : mesh.face_edges(fi)) {
+      if (mesh.edge(ei).contains(vi) && count_valid_faces(mesh, ei) != 2)
+        return false;
+    }
+  }
+  return has_faces;
+}
+
+/// @brief Returns sorted vertices sharing a valid face with a given vertex
+template <typename Mesh>
+void collect_neighbors(const Mesh& mesh, vertex_index vi,
+                       std::vector<vertex_index>& neighbors) {
+  neighbors.clear();
+  for (auto&& fi : mesh.vertex_faces(vi)) {
+    if (!mesh.is_valid(fi)) continue;
+    for (auto&& vj : mesh.face(fi))
+      if (vj != vi) neighbors.push_back(vj);
+  }
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                  neighbors.end());
+}
+
+/// @brief Checks if vertex b can be merged into vertex a
+///
+/// The edge must be interior, b must be an interior vertex, the link condition
+/// must hold, and no face may be flipped.
+template <typename Mesh>
+bool can_collapse(const Mesh& mesh, edge_index ei, vertex_index a,
+                  vertex_index b, std::vector<vertex_index>& na,
+                  std::vector<vertex_index>& nb) {
+  if (count_valid_faces(mesh, ei) != 2) return false;
+  if (!is_interior_vertex(mesh, b)) return false;
+
+  collect_neighbors(mesh, a, na);
+  collect_neighbors(mesh, b, nb);
+  std::size_t num_common = 0;
+  for (auto ia = na.begin(), ib = nb.begin(); ia != na.end() && ib != nb.end();) {
+    if (*ia < *ib) {
+      ++ia;
+    } else if (*ib < *ia) {
+      ++ib;
+    } else {
+      ++num_common;
+      ++ia;
+      ++ib;
+    }
+  }
+  if (num_common != 2) return false;
+
+  for (auto&& fi : mesh.vertex_faces(b)) {
+    if (!mesh.is_valid(fi)) continue;
+    auto f = mesh.face(fi);
+    if (f.contains(a)) continue;
+    const auto n0 = area_vector(mesh, f);
+    std::replace(f.begin(), f.end(), b, a);
+    const auto n1 = area_vector(mesh, f);
+    if (dot(n0, n1) <= 0.0) return false;
+  }
+  return true;
+}
+
+/// @brief Faces replaced by merging vertex b into vertex a
+template <typename Face>
+struct collapse_pattern {
+  vertex_index a;
+  vertex_index b;
+  /// Valid faces around b
+  std::vector<face_index> old_faces;
+  /// New faces with their parents
+  std::vector<std::pair<Face, face_index>> new_faces;
+};
+
+/// @brief Computes faces replaced by merging vertex b into vertex a
+template <typename Mesh>
+void find_collapse_pattern(
+    const Mesh& mesh, collapse_pattern<typename Mesh::face_type>& pattern) {
+  pattern.old_faces.clear();
+  pattern.new_faces.clear();
+  for (auto&& fi : mesh.vertex_faces(pattern.b)) {
+    if (!mesh.is_valid(fi)) continue;
+    pattern.old_faces.push_back(fi);
+    auto f = mesh.face(fi);
+    if (f.contains(pattern.a)) continue;
+    std::replace(f.begin(), f.end(), pattern.b, pattern.a);
+    pattern.new_faces.emplace_back(f, fi);
+  }
+}
+
+/// @brief Merges vertex b into vertex a
+template <typename Mesh, typename FaceFunction>
+void collapse(Mesh& mesh,
+              const collapse_pattern<typename Mesh::face_type>& pattern,
+              FaceFunction& prolongate_face,
+              std::vector<face_index>& new_faces) {
+  const auto current = mesh.current_fracture();
+  for (auto&& [f, fi] : pattern.new_faces) {
+    mesh.set_current_fracture(mesh.face_fracture(fi));
+    const auto gi = mesh.add_face(f);
+    new_faces.push_back(gi);
+    prolongate_face(gi, fi);
+  }
+  for (auto&& fi : pattern.old_faces) mesh.invalidate(fi);
+  mesh.set_current_fracture(current);
+}
+
+}  // namespace detail
+
+/// @brief Coarsens a triangular mesh by collapsing cheap edges
+/// @param[in,out] mesh Mesh of tri_face
+/// @param[in] cost Function called as `cost(ei)` returning the cost of
+/// collapsing an edge, e.g. its length. It is called from several threads at
+/// once.
+/// @param[in] max_cost Edges whose cost exceeds this value are kept
+/// @param[in] prolongate_face Function called as `f(new_face, old_face)` for
+/// each face rebuilt around a collapsed edge
+/// @param[in] batch_size The largest number of collapses in a batch
+/// @return The number of collapses and maps from old to new indices
+/// @throw std::invalid_argument If batch_size is zero
+/// @throw std::logic_error If a checkpoint is active, since invalid entities
+/// are removed at the end
+///
+/// Edges are collapsed in increasing order of cost from a priority queue. An
+/// edge is collapsed by merging one of its vertices into the other, so vertex
+/// positions are never changed. The merged vertex must be an interior vertex,
+/// which keeps boundaries and branching edges intact.
+///
+/// Collapses are grouped into batches whose neighborhoods are disjoint, so the
+/// collapses in a batch are independent of each other. Candidates are popped
+/// from the queue up to the free space of a batch, and their costs and
+/// collapsibility are evaluated in parallel. Faces replaced by the collapses
+/// of a batch are computed in parallel as well. Popping candidates, selecting
+/// them in order of cost, and inserting the new faces by add_face() and
+/// invalidate() run on the calling thread, since they update the queue and
+/// adjacency shared between collapses. Invalid mesh entities are removed at
+/// the end.
+template <typename Mesh, typename CostFunction, typename FaceFunction>
+decimation_result decimate(Mesh& mesh, CostFunction&& cost, double max_cost,
+                           FaceFunction&& prolongate_face,
+                           std::size_t batch_size = 1024) {
+  using face_type = typename Mesh::face_type;
+  static_assert(face_type::num_vertices == 3,
+                "Only triangular faces are supported.");
+  FMESH_SCOPED_TIMER("fmesh::decimate");
+  if (batch_size == 0) {
+    throw std::invalid_argument{"fmesh::decimate: batch_size must be positive"};
+  }
+  if (mesh.num_checkpoints() != 0) {
+    throw std::logic_error{"fmesh::decimate: a checkpoint is active"};
+  }
+  mesh.build_caches();
+
+  struct entry {
+    double cost;
+    edge_index edge;
+  };
+  const auto greater = [](const entry& x, const entry& y) {
+    return x.cost > y.cost || (x.cost == y.cost && x.edge > y.edge);
+  };
+  using queue_type =
+      std::priority_queue<entry, std::vector<entry>, decltype(greater)>;
+
+  // Pushes edges whose costs do not exceed max_cost
+  const auto evaluate = [&](std::vector<entry>& entries) {
+    parallel_for(entries, [&cost](entry& x) { x.cost = cost(x.edge); });
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [max_cost](const entry& x) {
+                                   return x.cost > max_cost;
+                                 }),
+                  entries.end());
+  };
+  std::vector<entry> entries;
+  for (auto&& ei : mesh.edges())
+    if (mesh.is_valid(ei)) entries.push_back({0.0, ei});
+  evaluate(entries);
+  queue_type queue{greater, std::move(entries)};
+  entries.clear();
+
+  // A collapse popped from the queue
+  struct candidate {
+    entry top;
+    double cost;
+    vertex_index a;
+    vertex_index b;
+    std::vector<vertex_index> na;
+    std::vector<vertex_index> nb;
+  };
+
+  decimation_result result;
+  std::vector<std::size_t> locked;
+  std::vector<entry> deferred;
+  std::vector<candidate> candidates;
+  std::vector<detail::collapse_pattern<face_type>> selected;
+  std::size_t num_selected = 0;
+  std::vector<face_index> new_faces;
+
+  while (!queue.empty()) {
+    const auto batch = result.num_batches + 1;
+    locked.resize(mesh.num_vertices(), 0);
+
+    // Select an independent set of collapses
+    while (num_selected < batch_size && !queue.empty()) {
+      std::size_t m = 0;
+      while (m < batch_size - num_selected && !queue.empty()) {
+        const auto top = queue.top();
+        queue.pop();
+        if (!mesh.is_valid(top.edge)) continue;
+        if (candidates.size() == m) candidates.emplace_back();
+        candidates[m++].top = top;
+      }
+
+      const auto popped =
+          make_iterator_range(candidates.data(), candidates.data() + m);
+      parallel_for(popped, [&](candidate& x) {
+        x.cost = cost(x.top.edge);
+        x.a = vertex_index{};
+        if (x.cost > max_cost || x.cost > x.top.cost) return;
+        const auto& e = mesh.edge(x.top.edge);
+        if (detail::can_collapse(mesh, x.top.edge, e.first, e.second, x.na,
+                                 x.nb)) {
+          x.a = e.first;
+          x.b = e.second;
+        } else if (detail::can_collapse(mesh, x.top.edge, e.second, e.first,
+                                        x.na, x.nb)) {
+          x.a = e.second;
+          x.b = e.first;
+        }
+      });
+
+      // Candidates are selected in order of cost. na and nb hold the
+      // neighborhoods of a and b.
+      const auto is_locked = [&](vertex_index vi) {
+        return locked[vi.get()] == batch;
+      };
+      for (auto&& x : popped) {
+        if (x.cost > max_cost) continue;
+        if (x.cost > x.top.cost) {
+          queue.push({x.cost, x.top.edge});
+          continue;
+        }
+        if (!x.a.is_valid()) continue;
+        if (std::any_of(x.na.begin(), x.na.end(), is_locked) ||
+            std::any_of(x.nb.begin(), x.nb.end(), is_locked)) {
+          deferred.push_back(x.top);
+          continue;
+        }
+        for (auto&& vi : x.na) locked[vi.get()] = batch;
+        for (auto&& vi : x.nb) locked[vi.get()] = batch;
+        if (selected.size() == num_selected) selected.emplace_back();
+        selected[num_selected].a = x.a;
+        selected[num_selected].b = x.b;
+        ++num_selected;
+      }
+    }
+
+    if (num_selected == 0) break;
+
+    const auto collapses =
+        make_iterator_range(selected.data(), selected.data() + num_selected);
+    parallel_for(collapses, [&mesh](auto& pattern) {
+      detail::find_collapse_pattern(mesh, pattern);
+    });
+    for (auto&& pattern : collapses)
+      detail::collapse(mesh, pattern, prolongate_face, new_faces);
+
+    result.num_collapses += num_selected;
+    result.num_batches = batch;
+
+    for (auto&& x : deferred) queue.push(x);
+    for (auto&& fi : new_faces)
+      if (fi.is_valid() && mesh.is_valid(fi))
+        for (auto&& ei : mesh.face_edges(fi)) entries.push_back({0.0, ei});
+    evaluate(entries);
+    for (auto&& x : entries) queue.push(x);
+
+    entries.clear();
+    deferred.clear();
+    new_faces.clear();
+    num_selected = 0;
+  }
+
+  result.remap = mesh.remove_invalid_entities();
+  return result;
+}
+
+/// @brief Coarsens a triangular mesh by collapsing cheap edges
+/// @param[in,out] mesh Mesh of tri_face
+/// @param[in] cost Function called as `cost(ei)` returning the cost of
+/// collapsing an edge
+/// @param[in] max_cost Edges whose cost exceeds this value are kept
+template <typename Mesh, typename CostFunction>
+decimation_result decimate(Mesh& mesh, CostFunction&& cost, double max_cost) {
+  return decimate(mesh, std::forward<CostFunction>(cost), max_cost,
+                  [](face_index, face_index) {});
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_DECIMATION_HPP
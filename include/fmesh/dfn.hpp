@@ -0,0 +1,346 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_DFN_HPP
+#define FMESH_DFN_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/point_traits.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Parameters of a synthetic discrete fracture network
+///
+/// Lengths are measured in cells of a uniform lattice covering the cubic
+/// domain [0, num_cells * cell_size]^3.
+struct dfn_parameters {
+  /// Seed of the random number generator
+  std::uint64_t seed = 0;
+  /// The number of fractures
+  std::size_t num_fractures = 16;
+  /// The number of cells of the domain along each axis
+  std::int64_t num_cells = 64;
+  /// Edge length of lattice cells
+  double cell_size = 1.0;
+  /// The smallest side length of fractures in cells
+  double min_length = 2.0;
+  /// The largest side length of fractures in cells
+  double max_length = 32.0;
+  /// Exponent a of the power-law density p(l) ~ l^-a of side lengths
+  double exponent = 2.5;
+};
+
+/// @brief Rectangular fracture of a synthetic network in lattice coordinates
+struct dfn_fracture {
+  /// Axis normal to the fracture (0: x, 1: y, 2: z)
+  int axis;
+  /// Lattice coordinate of the fracture plane along the normal axis
+  std::int64_t offset;
+  /// Lower corner along the in-plane axes (axis + 1) % 3 and (axis + 2) % 3
+  std::array<std::int64_t, 2> lower;
+  /// Upper corner along the in-plane axes
+  std::array<std::int64_t, 2> upper;
+};
+
+/// @brief Result of generate_dfn()
+struct dfn_result {
+  /// Fractures in the order they were sampled. Fracture k of the mesh is
+  /// fractures[k]; where coplanar fractures overlap, a face belongs to the
+  /// fracture sampled first.
+  std::vector<dfn_fracture> fractures;
+};
+
+namespace detail {
+
+/// @brief Random numbers reproducible across platforms
+///
+/// The sequence of std::mt19937_64 is fixed by the standard, but standard
+/// distributions are not, so they are implemented here.
+class dfn_random {
+ public:
+  explicit dfn_random(std::uint64_t seed) : engine_{seed} {}
+
+  /// @brief Returns a uniform random number in [0, 1)
+  double uniform() noexcept {
+    return static_cast<double>(engine_() >> 11) * 0x1.0p-53;
+  }
+
+  /// @brief Returns a uniform random integer in [0, n)
+  std::int64_t uniform(std::int64_t n) noexcept {
+    return std::min(static_cast<std::int64_t>(uniform() * n), n - 1);
+  }
+
+  /// @brief Returns a random number in [lmin, lmax] with density ~ l^-a
+  double power_law(double lmin, double lmax, double a) noexcept {
+    const auto u = uniform();
+    if (std::abs(a - 1.0) < 1e-12) return lmin * std::pow(lmax / lmin, u);
+    const auto b = 1.0 - a;
+    const auto p = std::pow(lmin, b);
+    return std::pow(p + u * (std::pow(lmax, b) - p), 1.0 / b);
+  }
+
+ private:
+  std::mt19937_64 engine_;
+};
+
+/// @brief Packs a lattice point into a key
+inline std::uint64_t lattice_key(std::int64_t i, std::int64_t j,
+                                 std::int64_t k) noexcept {
+  return (static_cast<std::uint64_t>(i) << 42) |
+         (static_cast<std::uint64_t>(j) << 21) | static_cast<std::uint64_t>(k);
+}
+
+/// @brief Hashes a key of a lattice point
+inline std::uint64_t hash_lattice_key(std::uint64_t key) noexcept {
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111eb;
+  return key ^ (key >> 31);
+}
+
+/// @brief Returns lattice point (u, v) of a fracture as (i, j, k)
+inline std::array<std::int64_t, 3> lattice_point(const dfn_fracture& fr,
+                                                 std::int64_t u,
+                                                 std::int64_t v) noexcept {
+  std::array<std::int64_t, 3> p;
+  p[fr.axis] = fr.offset;
+  p[(fr.axis + 1) % 3] = u;
+  p[(fr.axis + 2) % 3] = v;
+  return p;
+}
+
+inline std::vector<dfn_fracture> sample_fractures(const dfn_parameters& param) {
+  dfn_random random{param.seed};
+  const auto n = param.num_cells;
+  const auto side_length = [&random, &param, n]() {
+    const auto l = random.power_law(param.min_length, param.max_length,
+                                    param.exponent);
+    return std::clamp<std::int64_t>(std::llround(l), 1, n);
+  };
+
+  std::vector<dfn_fracture> fractures(param.num_fractures);
+  for (auto&& fr : fractures) {
+    fr.axis = static_cast<int>(random.uniform(3));
+    fr.offset = random.uniform(n + 1);
+    for (std::size_t d = 0; d < 2; ++d) {
+      const auto l = side_length();
+      const auto center = random.uniform(n);
+      fr.lower[d] = std::clamp<std::int64_t>(center - l / 2, 0, n - l);
+      fr.upper[d] = fr.lower[d] + l;
+    }
+  }
+  return fractures;
+}
+
+}  // namespace detail
+
+/// @brief Generates a synthetic discrete fracture network
+/// @param[out] mesh Empty mesh of triangles or quadrilaterals
+/// @param[in] param Parameters
+/// @return Sampled fractures and the fracture of each face
+/// @throw std::invalid_argument If parameters are out of range
+///
+/// Fractures are rectangles normal to a random coordinate axis whose side
+/// lengths follow a truncated power law. They are snapped to a lattice and
+/// meshed with its cells, split into two triangles for triangular meshes.
+/// Intersections of fractures therefore lie on lattice lines, which become
+/// edges shared by the faces of all intersecting fractures, i.e. branches.
+/// Fractures touching at a single lattice point make non-manifold vertices.
+///
+/// The network depends only on the parameters, so the same seed produces the
+/// same mesh on any platform and with any number of threads. Lattice points
+/// and cells shared by fractures are merged by hashing their keys, vertices
+/// and faces are numbered with prefix sums, and their arrays are filled in
+/// parallel. Then fracture_mesh::assign() builds the connectivity once.
+template <typename Mesh>
+dfn_result generate_dfn(Mesh& mesh, const dfn_parameters& param) {
+  FMESH_SCOPED_TIMER("fmesh::generate_dfn");
+  constexpr auto N = Mesh::face_type::num_vertices;
+  static_assert(N == 3 || N == 4,
+                "generate_dfn supports triangles and quadrilaterals only");
+  if (param.num_cells < 1 || param.num_cells >= (std::int64_t{1} << 21)) {
+    throw std::invalid_argument{
+        "fmesh::generate_dfn: num_cells must be in [1, 2^21)"};
+  }
+  if (!(param.cell_size > 0.0) || !(param.min_length > 0.0) ||
+      !(param.min_length <= param.max_length)) {
+    throw std::invalid_argument{
+        "fmesh::generate_dfn: lengths must satisfy 0 < min_length <= "
+        "max_length and cell_size > 0"};
+  }
+  if (mesh.num_faces() != 0 || mesh.num_vertices() != 0) {
+    throw std::invalid_argument{"fmesh::generate_dfn: mesh must be empty"};
+  }
+
+  dfn_result result;
+  result.fractures = detail::sample_fractures(param);
+  const auto& fractures = result.fractures;
+
+  const auto num_fractures = fractures.size();
+
+  // Lattice points and cells of fracture k are numbered from point_offsets[k]
+  // and cell_offsets[k] row by row along the second axis.
+  std::vector<std::size_t> point_offsets(num_fractures + 1, 0);
+  std::vector<std::size_t> cell_offsets(num_fractures + 1, 0);
+  for (std::size_t k = 0; k < num_fractures; ++k) {
+    const auto& fr = fractures[k];
+    const auto nu = static_cast<std::size_t>(fr.upper[0] - fr.lower[0]);
+    const auto nv = static_cast<std::size_t>(fr.upper[1] - fr.lower[1]);
+    point_offsets[k + 1] = point_offsets[k] + (nu + 1) * (nv + 1);
+    cell_offsets[k + 1] = cell_offsets[k] + nu * nv;
+  }
+  const auto num_points = point_offsets.back();
+  const auto num_cells = cell_offsets.back();
+  // Returns the fracture of a point or a cell.
+  const auto fracture_of = [](const std::vector<std::size_t>& offsets,
+                              std::size_t i) {
+    return static_cast<std::size_t>(
+        std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin() -
+        1);
+  };
+
+  std::vector<std::uint64_t> keys(num_points);
+  std::vector<std::size_t> ids(num_fractures);
+  for (std::size_t k = 0; k < ids.size(); ++k) ids[k] = k;
+  parallel_for(
+      ids,
+      [&](std::size_t k) {
+        const auto& fr = fractures[k];
+        auto n = point_offsets[k];
+        for (auto v = fr.lower[1]; v <= fr.upper[1]; ++v) {
+          for (auto u = fr.lower[0]; u <= fr.upper[0]; ++u, ++n) {
+            const auto p = detail::lattice_point(fr, u, v);
+            keys[n] = detail::lattice_key(p[0], p[1], p[2]);
+          }
+        }
+      },
+      1);
+
+  // Vertices are numbered in the order of the first occurrences of points.
+  const auto first_points = detail::first_occurrences(
+      num_points, [&keys](std::size_t n) { return keys[n]; },
+      detail::hash_lattice_key);
+  std::vector<std::uint8_t> is_vertex(num_points);
+  detail::for_each_chunk(num_points, 4096,
+                         [&](std::size_t begin, std::size_t end) {
+                           for (auto n = begin; n < end; ++n)
+                             is_vertex[n] = first_points[n] == n;
+                         });
+  const auto vertex_ranks = detail::count_flags(is_vertex);
+
+  using point_type = typename Mesh::point_type;
+  std::vector<point_type> points(vertex_ranks.back());
+  detail::for_each_chunk(
+      num_points, 4096, [&](std::size_t begin, std::size_t end) {
+        for (auto n = begin; n < end; ++n) {
+          if (!is_vertex[n]) continue;
+          const auto k = fracture_of(point_offsets, n);
+          const auto& fr = fractures[k];
+          const auto nu = static_cast<std::size_t>(fr.upper[0] - fr.lower[0]);
+          const auto i = n - point_offsets[k];
+          const auto p = detail::lattice_point(
+              fr, fr.lower[0] + static_cast<std::int64_t>(i % (nu + 1)),
+              fr.lower[1] + static_cast<std::int64_t>(i / (nu + 1)));
+          points[vertex_ranks[n]] = point_traits<point_type>::make(
+              param.cell_size * static_cast<double>(p[0]),
+              param.cell_size * static_cast<double>(p[1]),
+              param.cell_size * static_cast<double>(p[2]));
+        }
+      });
+
+  // Returns the lower corner of a cell.
+  const auto lower_corner = [&](std::size_t c) {
+    const auto k = fracture_of(cell_offsets, c);
+    const auto& fr = fractures[k];
+    const auto nu = static_cast<std::size_t>(fr.upper[0] - fr.lower[0]);
+    const auto i = c - cell_offsets[k];
+    return std::pair{k, point_offsets[k] + (i / nu) * (nu + 1) + i % nu};
+  };
+  // Cells are keyed by their lower corner, so that coplanar fractures share
+  // keys of overlapping cells. A cell is meshed by its first fracture.
+  const auto first_cells = detail::first_occurrences(
+      num_cells,
+      [&](std::size_t c) {
+        const auto [k, n] = lower_corner(c);
+        return std::pair{keys[n], fractures[k].axis};
+      },
+      [](const std::pair<std::uint64_t, int>& key) {
+        return detail::hash_lattice_key(key.first) +
+               static_cast<std::uint64_t>(key.second);
+      });
+  std::vector<std::uint8_t> is_meshed(num_cells);
+  detail::for_each_chunk(num_cells, 4096,
+                         [&](std::size_t begin, std::size_t end) {
+                           for (auto c = begin; c < end; ++c)
+                             is_meshed[c] = first_cells[c] == c;
+                         });
+  const auto cell_ranks = detail::count_flags(is_meshed);
+
+  constexpr std::size_t faces_per_cell = N == 3 ? 2 : 1;
+  std::vector<std::size_t> face_offsets(num_fractures + 1);
+  for (std::size_t k = 0; k <= num_fractures; ++k)
+    face_offsets[k] = faces_per_cell * cell_ranks[cell_offsets[k]];
+
+  using face_type = typename Mesh::face_type;
+  std::vector<face_type> faces(face_offsets.back());
+  detail::for_each_chunk(
+      num_cells, 4096, [&](std::size_t begin, std::size_t end) {
+        const auto vertex = [&](std::size_t n) {
+          return vertex_index{vertex_ranks[first_points[n]]};
+        };
+        for (auto c = begin; c < end; ++c) {
+          if (!is_meshed[c]) continue;
+          const auto [k, n] = lower_corner(c);
+          const auto& fr = fractures[k];
+          const auto nu = static_cast<std::size_t>(fr.upper[0] - fr.lower[0]);
+          const auto v0 = vertex(n);
+          const auto v1 = vertex(n + 1);
+          const auto v2 = vertex(n + nu + 2);
+          const auto v3 = vertex(n + nu + 1);
+          auto* f = &faces[faces_per_cell * cell_ranks[c]];
+          if constexpr (N == 3) {
+            f[0] = face_type(v0, v1, v2);
+            f[1] = face_type(v0, v2, v3);
+          } else {
+            f[0] = face_type(v0, v1, v2, v3);
+          }
+        }
+      });
+
+  mesh.assign(points, faces, face_offsets);
+  return result;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_DFN_HPP
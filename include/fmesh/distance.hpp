@@ -0,0 +1,402 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_DISTANCE_HPP
+#define FMESH_DISTANCE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Solvers of geodesic distance
+enum class distance_method {
+  /// Fast marching, which accepts vertices in the order of distance
+  fast_marching,
+  /// Parallel Jacobi sweeps over the vertices next to changed vertices
+  parallel_sweep,
+};
+
+/// @brief Vertex with a known distance to the front
+///
+/// A front between vertices, e.g. the tip line of a fracture, is given by the
+/// vertices next to it and their distances to it.
+struct distance_seed {
+  vertex_index vertex;
+  double distance = 0.0;
+};
+
+/// @brief Options of geodesic distance
+struct distance_options {
+  distance_method method = distance_method::fast_marching;
+  /// Radius of the narrow band. Vertices farther from the front are left at
+  /// infinity, and work is proportional to the number of vertices within it.
+  double max_distance = std::numeric_limits<double>::infinity();
+  /// Relative decrease below which parallel sweeps stop updating a vertex
+  double tolerance = 1e-12;
+  /// The number of vertices updated by a task of parallel sweeps
+  std::size_t grain = 256;
+};
+
+/// @brief Reusable scratch buffers of geodesic distance
+///
+/// The workspace remembers the vertices set by the last computation, so that
+/// the next computation into the same distance array resets only them instead
+/// of the whole array. Vertices are marked by stamping them with the
+/// generation of the current computation, and buffers only grow.
+class distance_workspace {
+ public:
+  /// @brief Returns vertices within the band of the last computation
+  const std::vector<vertex_index>& band() const noexcept { return band_; }
+
+  /// @brief Sets all distances to infinity and starts a new computation
+  /// @param[in,out] distances Distances written by the last computation with
+  /// this workspace, or any array, which is then filled entirely
+  /// @param[in] n The number of vertices
+  void clear(vertex_property<double>& distances, std::size_t n) {
+    constexpr auto inf = std::numeric_limits<double>::infinity();
+    if (distances.data() != target_ || distances.size() != n) {
+      distances.clear();
+      distances.resize(n, inf);
+    } else {
+      for (auto&& vi : band_) distances[vi] = inf;
+    }
+    target_ = distances.data();
+
+    if (stamps_.size() < n) stamps_.resize(n, 0);
+    generation_ += 2;
+    if (generation_ < 2) {
+      std::fill(stamps_.begin(), stamps_.end(), 0);
+      generation_ = 2;
+    }
+    band_.clear();
+  }
+
+  /// @brief Adds a vertex to the band
+  void insert(vertex_index vi) {
+    auto& stamp = stamps_[vi.get()];
+    if (stamp >= generation_) return;
+    stamp = generation_;
+    band_.push_back(vi);
+  }
+
+  /// @brief Marks a vertex in the band as final
+  void accept(vertex_index vi) noexcept { stamps_[vi.get()] = generation_ + 1; }
+
+  /// @brief Checks if the distance of a vertex is final
+  bool is_accepted(vertex_index vi) const noexcept {
+    return stamps_[vi.get()] == generation_ + 1;
+  }
+
+  /// @name Scratch buffers of solvers
+  /// @{
+  std::vector<std::pair<double, vertex_index>>& heap() noexcept {
+    return heap_;
+  }
+  std::vector<vertex_index>& active() noexcept { return active_; }
+  std::vector<vertex_index>& next_active() noexcept { return next_active_; }
+  std::vector<double>& values() noexcept { return values_; }
+  /// @}
+
+  /// @brief Adds a vertex to the next round of parallel sweeps once
+  void activate(vertex_index vi) {
+    if (marks_.size() <= vi.get()) marks_.resize(stamps_.size(), 0);
+    auto& mark = marks_[vi.get()];
+    if (mark == round_) return;
+    mark = round_;
+    next_active_.push_back(vi);
+  }
+
+  /// @brief Starts a new round of parallel sweeps
+  void next_round() {
+    std::swap(active_, next_active_);
+    next_active_.clear();
+    if (++round_ == 0) {
+      std::fill(marks_.begin(), marks_.end(), 0);
+      round_ = 1;
+    }
+  }
+
+ private:
+  std::vector<vertex_index> band_;
+  std::vector<std::uint32_t> stamps_;
+  std::uint32_t generation_ = 0;
+  const double* target_ = nullptr;
+
+  std::vector<std::pair<double, vertex_index>> heap_;
+  std::vector<vertex_index> active_;
+  std::vector<vertex_index> next_active_;
+  std::vector<double> values_;
+  std::vector<std::uint32_t> marks_;
+  std::uint32_t round_ = 1;
+};
+
+namespace detail {
+
+/// @brief Returns the distance at c from known distances at a and b of
+/// triangle abc
+///
+/// The front is assumed to be planar over the triangle. If the front does not
+/// reach c through the triangle, e.g. at obtuse angles, the shorter path along
+/// edges ca and cb is taken.
+inline double triangle_distance(const vector3& c, const vector3& a,
+                                const vector3& b, double ta,
+                                double tb) noexcept {
+  const auto u = a - c;
+  const auto v = b - c;
+  const auto along_edges = std::min(ta + norm(u), tb + norm(v));
+
+  const auto uu = dot(u, u);
+  const auto uv = dot(u, v);
+  const auto vv = dot(v, v);
+  const auto det = uu * vv - uv * uv;
+  if (det <= 1e-12 * uu * vv) return along_edges;
+
+  // The distance t is linear over the triangle with unit gradient g, which is
+  // g = [u v] w with w = G^-1 (ta - t, tb - t) and the Gram matrix G.
+  const auto a2 = (uu + vv - 2.0 * uv) / det;
+  const auto b2 = ((vv - uv) * ta + (uu - uv) * tb) / det;
+  const auto c2 = (vv * ta * ta - 2.0 * uv * ta * tb + uu * tb * tb) / det -
+                  1.0;
+  const auto disc = b2 * b2 - a2 * c2;
+  if (disc < 0.0) return along_edges;
+  const auto t = (b2 + std::sqrt(disc)) / a2;
+
+  // The front must arrive at c from inside the triangle.
+  const auto w0 = (vv * (ta - t) - uv * (tb - t)) / det;
+  const auto w1 = (uu * (tb - t) - uv * (ta - t)) / det;
+  if (w0 > 0.0 || w1 > 0.0 || t < std::max(ta, tb)) return along_edges;
+  return std::min(t, along_edges);
+}
+
+/// @brief Returns the distance at a vertex of a face from distances at the
+/// other vertices of the face
+/// @param[in] is_known Function which tells if a distance can be used
+///
+/// Faces are split into triangles fanning out from the vertex, so that
+/// triangles and quadrilaterals are handled alike.
+template <typename Mesh, typename Face, typename Known>
+double face_distance(const Mesh& mesh, const Face& f, vertex_index vi,
+                     const vertex_property<double>& distances,
+                     Known&& is_known) {
+  constexpr auto inf = std::numeric_limits<double>::infinity();
+  const auto n = f.size();
+  std::size_t i = 0;
+  while (f[i] != vi) ++i;
+
+  const auto c = to_vector3(mesh.vertex(vi));
+  auto t = inf;
+  for (std::size_t k = 1; k + 1 < n; ++k) {
+    const auto va = f[(i + k) % n];
+    const auto vb = f[(i + k + 1) % n];
+    const auto ka = is_known(va);
+    const auto kb = is_known(vb);
+    if (ka && kb) {
+      t = std::min(t, triangle_distance(c, to_vector3(mesh.vertex(va)),
+                                        to_vector3(mesh.vertex(vb)),
+                                        distances[va], distances[vb]));
+    } else if (ka) {
+      t = std::min(t, distances[va] +
+                          norm(to_vector3(mesh.vertex(va)) - c));
+    } else if (kb) {
+      t = std::min(t, distances[vb] +
+                          norm(to_vector3(mesh.vertex(vb)) - c));
+    }
+  }
+  return t;
+}
+
+template <typename Mesh>
+void fast_marching(const Mesh& mesh, vertex_property<double>& distances,
+                   distance_workspace& work, const distance_options& options) {
+  using entry = std::pair<double, vertex_index>;
+  const auto later = std::greater<entry>{};
+  auto& heap = work.heap();
+  for (auto&& vi : work.band()) heap.push_back({distances[vi], vi});
+  std::make_heap(heap.begin(), heap.end(), later);
+
+  const auto is_known = [&work](vertex_index vi) {
+    return work.is_accepted(vi);
+  };
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    const auto [d, vi] = heap.back();
+    heap.pop_back();
+    if (work.is_accepted(vi) || d > distances[vi]) continue;
+    work.accept(vi);
+
+    for (auto&& fi : mesh.vertex_faces(vi)) {
+      if (!mesh.is_valid(fi)) continue;
+      const auto& f = mesh.face(fi);
+      for (auto&& vj : f) {
+        if (vj == vi || work.is_accepted(vj)) continue;
+        const auto t = face_distance(mesh, f, vj, distances, is_known);
+        if (t < distances[vj] && t <= options.max_distance) {
+          work.insert(vj);
+          distances[vj] = t;
+          heap.push_back({t, vj});
+          std::push_heap(heap.begin(), heap.end(), later);
+        }
+      }
+    }
+  }
+}
+
+template <typename Mesh>
+void parallel_sweep(const Mesh& mesh, vertex_property<double>& distances,
+                    distance_workspace& work,
+                    const distance_options& options) {
+  const auto activate_neighbors = [&mesh, &work](vertex_index vi) {
+    for (auto&& fi : mesh.vertex_faces(vi)) {
+      if (!mesh.is_valid(fi)) continue;
+      for (auto&& vj : mesh.face(fi))
+        if (vj != vi) work.activate(vj);
+    }
+  };
+  // Vertex-faces are cached here, before any parallel access, if they are not
+  // maintained.
+  for (auto&& vi : work.band()) activate_neighbors(vi);
+  work.next_round();
+
+  const auto is_known = [&distances](vertex_index vi) {
+    return distances[vi] < std::numeric_limits<double>::infinity();
+  };
+  const auto grain = std::max<std::size_t>(options.grain, 1);
+  std::vector<std::size_t> chunks;
+  while (!work.active().empty()) {
+    const auto& active = work.active();
+    auto& values = work.values();
+    const auto n = active.size();
+    values.resize(n);
+
+    // Jacobi update: new values depend only on values of the last round.
+    chunks.resize((n + grain - 1) / grain);
+    for (std::size_t c = 0; c < chunks.size(); ++c) chunks[c] = c;
+    parallel_for(
+        chunks,
+        [&](std::size_t c) {
+          const auto end = std::min(n, (c + 1) * grain);
+          for (auto i = c * grain; i < end; ++i) {
+            const auto vi = active[i];
+            auto t = distances[vi];
+            for (auto&& fi : mesh.vertex_faces(vi)) {
+              if (!mesh.is_valid(fi)) continue;
+              t = std::min(t, face_distance(mesh, mesh.face(fi), vi,
+                                            distances, is_known));
+            }
+            values[i] = t;
+          }
+        },
+        1);
+
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto vi = active[i];
+      const auto t = values[i];
+      if (t > options.max_distance ||
+          !(t < distances[vi] - options.tolerance * std::max(1.0, t)))
+        continue;
+      work.insert(vi);
+      distances[vi] = t;
+      activate_neighbors(vi);
+    }
+    work.next_round();
+  }
+}
+
+}  // namespace detail
+
+/// @brief Computes geodesic distances from a front over the surface
+/// @param[in] mesh Mesh of triangular or quadrilateral faces
+/// @param[in] seeds Vertices with known distances to the front
+/// @param[in,out] distances Distances of vertices. Vertices beyond the narrow
+/// band or unreachable from the seeds are set to infinity.
+/// @param[in,out] work Workspace, which is reused across computations
+/// @param[in] options Options
+/// @throw std::invalid_argument If a seed is not a valid vertex
+///
+/// Distances propagate through all valid faces around a vertex, so fronts
+/// cross branching edges into every fracture sharing them. The work is
+/// proportional to the number of vertices within options.max_distance if the
+/// same workspace and distance array are used for every computation. Both
+/// methods give the same distances up to the tolerance when every triangle
+/// is acute; parallel sweeps can be smaller near obtuse angles.
+///
+/// If vertex-faces are not maintained by the mesh, they are cached on the
+/// first call after a topology change.
+template <typename Mesh>
+void geodesic_distance(const Mesh& mesh,
+                       const std::vector<distance_seed>& seeds,
+                       vertex_property<double>& distances,
+                       distance_workspace& work,
+                       const distance_options& options = {}) {
+  FMESH_SCOPED_TIMER("fmesh::geodesic_distance");
+  const auto nv = mesh.num_vertices();
+  for (auto&& seed : seeds) {
+    if (!(seed.vertex.get() < nv) || !mesh.is_valid(seed.vertex)) {
+      throw std::invalid_argument{
+          "fmesh::geodesic_distance: seed is not a valid vertex"};
+    }
+  }
+
+  work.clear(distances, nv);
+  work.heap().clear();
+  for (auto&& seed : seeds) {
+    if (seed.distance > options.max_distance ||
+        !(seed.distance < distances[seed.vertex]))
+      continue;
+    work.insert(seed.vertex);
+    distances[seed.vertex] = seed.distance;
+  }
+
+  if (options.method == distance_method::fast_marching) {
+    detail::fast_marching(mesh, distances, work, options);
+  } else {
+    detail::parallel_sweep(mesh, distances, work, options);
+  }
+}
+
+/// @brief Computes geodesic distances from a front over the whole surface
+template <typename Mesh>
+vertex_property<double> geodesic_distance(
+    const Mesh& mesh, const std::vector<distance_seed>& seeds,
+    const distance_options& options = {}) {
+  vertex_property<double> distances;
+  distance_workspace work;
+  geodesic_distance(mesh, seeds, distances, work, options);
+  return distances;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_DISTANCE_HPP
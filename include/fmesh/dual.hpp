@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_DUAL_HPP
+#define FMESH_DUAL_HPP
+
+#include <cmath>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Vertex-centred dual mesh in flat arrays
+///
+/// Each face of a mesh with N vertices per face is split into N corners by
+/// dual faces connecting the midpoints of its edges to its centroid. The
+/// values of corner k and of the dual face crossing edge k of face fi are
+/// stored at fi * N + k, where edge k connects vertices k and k + 1 as in
+/// Face::to_edges(). Values of invalid faces are zero.
+///
+/// Control volumes at branching edges collect corners of all faces meeting
+/// there, and each face contributes its own dual face to the flux across the
+/// edge.
+struct dual_mesh {
+  /// The number of vertices per face
+  std::size_t num_face_vertices = 0;
+  /// Area of the control volume of each vertex
+  vertex_property<double> volumes;
+  /// Area of each face corner
+  std::vector<double> corner_areas;
+  /// Unit normal of each dual face, tangent to the face and oriented from
+  /// vertex k to vertex k + 1
+  std::vector<vector3> normals;
+  /// Length of each dual face
+  std::vector<double> lengths;
+  /// Edge crossed by each dual face
+  std::vector<edge_index> edges;
+};
+
+/// @brief Builds median-dual control volumes
+/// @param[in] mesh Mesh
+///
+/// Corners of triangles have a third of the face area. Corners of other faces
+/// are quadrilaterals spanned by the vertex, the midpoints of its two edges,
+/// and the centroid. Faces are processed in parallel, and control volumes are
+/// summed up in face order afterwards.
+template <typename Mesh>
+dual_mesh median_dual(const Mesh& mesh) {
+  FMESH_SCOPED_TIMER("fmesh::median_dual");
+  constexpr auto N = Mesh::face_type::num_vertices;
+
+  dual_mesh dual;
+  dual.num_face_vertices = N;
+  dual.volumes.resize(mesh.num_vertices(), 0.0);
+  const auto n = N * mesh.num_faces();
+  dual.corner_areas.resize(n, 0.0);
+  dual.normals.resize(n);
+  dual.lengths.resize(n, 0.0);
+  dual.edges.resize(n);
+
+  // Faces only write their own corners and dual faces.
+  parallel_for_valid(mesh, mesh.faces(), [&mesh, &dual](face_index fi) {
+    const auto& f = mesh.face(fi);
+    const auto offset = N * fi.get();
+
+    vector3 p[N];
+    vector3 m[N];
+    for (std::size_t k = 0; k < N; ++k) p[k] = to_vector3(mesh.vertex(f[k]));
+    for (std::size_t k = 0; k < N; ++k) m[k] = 0.5 * (p[k] + p[(k + 1) % N]);
+    const auto c = centroid(mesh, f);
+    const auto a = area_vector(mesh, f);
+    const auto normal = a / norm(a);
+
+    if constexpr (N == 3) {
+      const auto area = norm(a) / 3.0;
+      for (std::size_t k = 0; k < N; ++k) dual.corner_areas[offset + k] = area;
+    } else {
+      for (std::size_t k = 0; k < N; ++k) {
+        const auto& prev = m[(k + N - 1) % N];
+        dual.corner_areas[offset + k] =
+            0.5 * std::abs(dot(cross(c - p[k], m[k] - prev), normal));
+      }
+    }
+
+    const auto es = mesh.face_edges(fi);
+    for (std::size_t k = 0; k < N; ++k) {
+      const auto s = c - m[k];
+      auto nk = cross(s, normal);
+      if (dot(nk, p[(k + 1) % N] - p[k]) < 0.0) nk = -nk;
+      dual.lengths[offset + k] = norm(s);
+      dual.normals[offset + k] = nk / norm(nk);
+      dual.edges[offset + k] = es.begin()[k];
+    }
+  });
+
+  for (auto&& fi : mesh.faces()) {
+    if (!mesh.is_valid(fi)) continue;
+    const auto& f = mesh.face(fi);
+    for (std::size_t k = 0; k < N; ++k)
+      dual.volumes[f[k]] += dual.corner_areas[N * fi.get() + k];
+  }
+  return dual;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_DUAL_HPP
@@ -24,6 +24,7 @@
 #define FMESH_EDGE_HPP
 
 #include <iostream>
+#include <type_traits>
 
 #include "fmesh/index.hpp"
 
@@ -70,6 +71,10 @@ struct edge {
 using directed_edge = edge<true>;
 using undirected_edge = edge<false>;
 
+static_assert(sizeof(undirected_edge) == 2 * sizeof(vertex_index) &&
+                  std::is_trivially_copyable_v<undirected_edge>,
+              "Edges must be padding-free pairs of vertex indices.");
+
 }  // namespace fmesh
 
 #endif  // FMESH_EDGE_HPP
\ No newline at end of file
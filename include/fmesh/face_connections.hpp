@@ -0,0 +1,262 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_FACE_CONNECTIONS_HPP
+#define FMESH_FACE_CONNECTIONS_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+
+namespace fmesh {
+
+/// @brief Connections between faces sharing edges for flux assembly
+///
+/// A connection is created for every pair of valid faces sharing a valid
+/// edge, so an edge shared by k faces, e.g. a branching edge, has k(k - 1) / 2
+/// connections. Connections are stored as a structure of arrays grouped by
+/// edge in increasing order of edge index. The first face of a connection has
+/// the smaller index.
+///
+/// Optional geometric coefficients are the length of the shared edge and the
+/// distances from the centroids of the two faces to the midpoint of the edge.
+class face_connections {
+ public:
+  face_connections() = default;
+  explicit face_connections(bool with_geometry)
+      : with_geometry_{with_geometry} {}
+
+  /// @brief Builds connections of all edges
+  template <typename Mesh>
+  void build(const Mesh& mesh) {
+    FMESH_SCOPED_TIMER("fmesh::face_connections::build");
+    this->clear();
+    for (auto&& ei : mesh.edges()) this->append(mesh, ei);
+  }
+
+  /// @brief Rebuilds connections of given edges only
+  /// @param[in] mesh Mesh
+  /// @param[in] edges Edges whose incident faces have changed, including new
+  /// edges
+  ///
+  /// Connections of other edges are kept as they are. Edges keeping the
+  /// number of their connections are overwritten in place, so the cost is
+  /// proportional to the number of given edges. Otherwise, connections after
+  /// the first edge whose number has changed are moved once, which is cheap
+  /// for new edges appended at the end.
+  template <typename Mesh>
+  void update(const Mesh& mesh, std::vector<edge_index> edges) {
+    FMESH_SCOPED_TIMER("fmesh::face_connections::update");
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // New connections of the i-th edge are in [offsets[i], offsets[i + 1]).
+    face_connections fresh{with_geometry_};
+    std::vector<std::size_t> offsets{0};
+    offsets.reserve(edges.size() + 1);
+    for (auto&& ei : edges) {
+      fresh.append(mesh, ei);
+      offsets.push_back(fresh.size());
+    }
+
+    std::size_t i = 0;
+    for (; i < edges.size(); ++i) {
+      const auto [first, last] = this->find(edges[i]);
+      if (last - first != offsets[i + 1] - offsets[i]) break;
+      for (auto k = first; k < last; ++k)
+        this->assign(k, fresh, offsets[i] + k - first);
+    }
+    if (i == edges.size()) return;
+
+    // Connections from the first edge whose number has changed are merged.
+    const auto start = this->find(edges[i]).first;
+    face_connections tail{with_geometry_};
+    tail.reserve(this->size() - start);
+    for (auto k = start; k < this->size(); ++k) tail.push_back(*this, k);
+    this->resize(start);
+    this->reserve(start + tail.size() + fresh.size());
+
+    std::size_t k = 0;
+    const auto copy_until = [&](edge_index last) {
+      for (; k < tail.size() && tail.edges_[k] < last; ++k)
+        this->push_back(tail, k);
+    };
+    for (; i < edges.size(); ++i) {
+      copy_until(edges[i]);
+      while (k < tail.size() && tail.edges_[k] == edges[i]) ++k;
+      for (auto j = offsets[i]; j < offsets[i + 1]; ++j)
+        this->push_back(fresh, j);
+    }
+    copy_until(edge_index{mesh.num_edges()});
+  }
+
+  std::size_t size() const noexcept { return edges_.size(); }
+  bool empty() const noexcept { return edges_.empty(); }
+  bool has_geometry() const noexcept { return with_geometry_; }
+
+  void clear() noexcept {
+    first_faces_.clear();
+    second_faces_.clear();
+    edges_.clear();
+    edge_lengths_.clear();
+    first_distances_.clear();
+    second_distances_.clear();
+  }
+
+  void reserve(std::size_t n) {
+    first_faces_.reserve(n);
+    second_faces_.reserve(n);
+    edges_.reserve(n);
+    if (!with_geometry_) return;
+    edge_lengths_.reserve(n);
+    first_distances_.reserve(n);
+    second_distances_.reserve(n);
+  }
+
+  void swap(face_connections& other) noexcept {
+    using std::swap;
+    swap(with_geometry_, other.with_geometry_);
+    first_faces_.swap(other.first_faces_);
+    second_faces_.swap(other.second_faces_);
+    edges_.swap(other.edges_);
+    edge_lengths_.swap(other.edge_lengths_);
+    first_distances_.swap(other.first_distances_);
+    second_distances_.swap(other.second_distances_);
+  }
+
+  /// @name Arrays of connections
+  /// @{
+  const std::vector<face_index>& first_faces() const noexcept {
+    return first_faces_;
+  }
+  const std::vector<face_index>& second_faces() const noexcept {
+    return second_faces_;
+  }
+  const std::vector<edge_index>& edges() const noexcept { return edges_; }
+
+  /// Empty if geometric coefficients are not computed
+  const std::vector<double>& edge_lengths() const noexcept {
+    return edge_lengths_;
+  }
+  const std::vector<double>& first_distances() const noexcept {
+    return first_distances_;
+  }
+  const std::vector<double>& second_distances() const noexcept {
+    return second_distances_;
+  }
+  /// @}
+
+ private:
+  /// @brief Appends connections of an edge
+  template <typename Mesh>
+  void append(const Mesh& mesh, edge_index ei) {
+    if (!mesh.is_valid(ei)) return;
+    const auto fs = mesh.edge_faces(ei);
+
+    vector3 m;
+    double length = 0.0;
+    if (with_geometry_) {
+      const auto& e = mesh.edge(ei);
+      const auto p1 = to_vector3(mesh.vertex(e.first));
+      const auto p2 = to_vector3(mesh.vertex(e.second));
+      m = 0.5 * (p1 + p2);
+      length = norm(p2 - p1);
+    }
+
+    for (auto i = fs.begin(); i != fs.end(); ++i) {
+      if (!mesh.is_valid(*i)) continue;
+      for (auto j = i + 1; j != fs.end(); ++j) {
+        if (!mesh.is_valid(*j)) continue;
+        const auto fi = std::min(*i, *j);
+        const auto fj = std::max(*i, *j);
+        first_faces_.push_back(fi);
+        second_faces_.push_back(fj);
+        edges_.push_back(ei);
+        if (!with_geometry_) continue;
+        edge_lengths_.push_back(length);
+        first_distances_.push_back(norm(centroid(mesh, mesh.face(fi)) - m));
+        second_distances_.push_back(norm(centroid(mesh, mesh.face(fj)) - m));
+      }
+    }
+  }
+
+  /// @brief Returns the range of connections of an edge
+  std::pair<std::size_t, std::size_t> find(edge_index ei) const {
+    const auto [first, last] =
+        std::equal_range(edges_.begin(), edges_.end(), ei);
+    return {static_cast<std::size_t>(first - edges_.begin()),
+            static_cast<std::size_t>(last - edges_.begin())};
+  }
+
+  /// @brief Overwrites the k-th connection by the j-th one of another list
+  void assign(std::size_t k, const face_connections& other, std::size_t j) {
+    first_faces_[k] = other.first_faces_[j];
+    second_faces_[k] = other.second_faces_[j];
+    edges_[k] = other.edges_[j];
+    if (!with_geometry_) return;
+    edge_lengths_[k] = other.edge_lengths_[j];
+    first_distances_[k] = other.first_distances_[j];
+    second_distances_[k] = other.second_distances_[j];
+  }
+
+  /// @brief Keeps the first n connections
+  void resize(std::size_t n) {
+    first_faces_.resize(n);
+    second_faces_.resize(n);
+    edges_.resize(n);
+    if (!with_geometry_) return;
+    edge_lengths_.resize(n);
+    first_distances_.resize(n);
+    second_distances_.resize(n);
+  }
+
+  /// @brief Appends the k-th connection of another list
+  void push_back(const face_connections& other, std::size_t k) {
+    first_faces_.push_back(other.first_faces_[k]);
+    second_faces_.push_back(other.second_faces_[k]);
+    edges_.push_back(other.edges_[k]);
+    if (!with_geometry_) return;
+    edge_lengths_.push_back(other.edge_lengths_[k]);
+    first_distances_.push_back(other.first_distances_[k]);
+    second_distances_.push_back(other.second_distances_[k]);
+  }
+
+  bool with_geometry_ = false;
+
+  /// @name Structure of arrays
+  /// @{
+  std::vector<face_index> first_faces_;
+  std::vector<face_index> second_faces_;
+  std::vector<edge_index> edges_;
+  std::vector<double> edge_lengths_;
+  std::vector<double> first_distances_;
+  std::vector<double> second_distances_;
+  /// @}
+};
+
+}  // namespace fmesh
+
+#endif  // FMESH_FACE_CONNECTIONS_HPP
@@ -39,6 +39,8 @@ class fixed_size_face {
  public:
   static_assert(N >= 3, "N must be larger than 3.");
 
+  static constexpr std::size_t num_vertices = N;
+
   fixed_size_face() = default;
 
   template <typename... Args>
@@ -137,6 +139,13 @@ class fixed_size_face {
 using tri_face = fixed_size_face<3>;
 using quad_face = fixed_size_face<4>;
 
+static_assert(sizeof(tri_face) == 3 * sizeof(vertex_index) &&
+                  std::is_trivially_copyable_v<tri_face>,
+              "Faces must be padding-free arrays of vertex indices.");
+static_assert(sizeof(quad_face) == 4 * sizeof(vertex_index) &&
+                  std::is_trivially_copyable_v<quad_face>,
+              "Faces must be padding-free arrays of vertex indices.");
+
 }  // namespace fmesh
 
 #endif  // FMESH_FIXED_SIZE_FACE_HPP
\ No newline at end of file
@@ -24,21 +24,206 @@
 #define FMESH_FRACTURE_MESH_HPP
 
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "fmesh/edge.hpp"
 #include "fmesh/index.hpp"
 #include "fmesh/index_iterator.hpp"
+#include "fmesh/instrumentation.hpp"
 #include "fmesh/iterator_range.hpp"
+#include "fmesh/parallel.hpp"
 #include "fmesh/property_array.hpp"
 
 namespace fmesh {
 
+/// @brief Maps from old to new indices of mesh entities
+///
+/// Removed mesh entities are mapped to invalid indices. Use compact() to apply
+/// the maps to property arrays.
+struct entity_remap {
+  vertex_property<vertex_index> vertices;
+  edge_property<edge_index> edges;
+  face_property<face_index> faces;
+};
+
+/// @brief Mesh entities created, modified, and removed by a local topology
+/// edit
+///
+/// Removed entities are invalidated, and new entities are appended, so
+/// existing property arrays stay valid after resizing them. Properties of new
+/// faces can be copied from their parent faces.
+struct topology_edit {
+  /// The vertex inserted by a split, or the vertex removed by a collapse
+  vertex_index vertex;
+  /// New edges
+  std::vector<edge_index> new_edges;
+  /// New faces and the faces they were split from
+  std::vector<std::pair<face_index, face_index>> new_faces;
+  /// Existing faces whose vertices were changed in place
+  std::vector<face_index> modified_faces;
+  /// Existing edges whose vertices were changed in place, or which were
+  /// invalid and are used again. Their properties must be recomputed.
+  std::vector<edge_index> modified_edges;
+  /// Invalidated edges
+  std::vector<edge_index> removed_edges;
+  /// Invalidated faces
+  std::vector<face_index> removed_faces;
+};
+
+/// @brief A change of a mesh entity recorded in the change log
+struct mesh_change {
+  enum class entity : std::uint8_t { vertex, edge, face, mesh };
+  enum class kind : std::uint8_t {
+    created,      ///< Added to the mesh
+    invalidated,  ///< Became invalid
+    validated,    ///< Became valid again, e.g. an edge reused by a new face
+    modified,     ///< Moved vertex, or edge or face changed in place
+    renumbered,   ///< All indices changed by rollback() or compaction
+  };
+  entity type;
+  kind change;
+  std::size_t index;
+};
+
+/// @brief Entities changed since an epoch
+///
+/// Connectivity of vertices and edges of created, invalidated, or modified
+/// faces may have changed as well.
+struct change_set {
+  /// Were indices renumbered? Then the lists are empty and all derived data
+  /// must be rebuilt.
+  bool renumbered = false;
+  /// Changed vertices in increasing order
+  std::vector<vertex_index> vertices;
+  /// Changed edges in increasing order
+  std::vector<edge_index> edges;
+  /// Changed faces in increasing order
+  std::vector<face_index> faces;
+};
+
+namespace detail {
+
+/// @brief A change recorded in an undo journal
+struct journal_entry {
+  enum class kind : std::uint8_t {
+    vertex_edge,      ///< Appended to vertex-edges and vertex-vertices
+    vertex_face,      ///< Appended to vertex-faces
+    edge_face,        ///< Appended to edge-faces
+    vertex_validity,  ///< Flipped the validity of a vertex
+    edge_validity,    ///< Flipped the validity of an edge
+    face_validity,    ///< Flipped the validity of a face
+  };
+  kind type;
+  std::size_t index;
+};
+
+/// @brief Mesh state at a checkpoint
+struct checkpoint_mark {
+  std::size_t num_vertices;
+  std::size_t num_edges;
+  std::size_t num_faces;
+  std::size_t journal_size;
+  bool has_invalid_vertices;
+  bool has_invalid_edges;
+  bool has_invalid_faces;
+};
+
+}  // namespace detail
+
+/// @brief Compile-time selection of optional connectivity relations
+/// @tparam VertexVertices Maintain vertex-vertices on every insertion?
+/// @tparam VertexFaces Maintain vertex-faces on every insertion?
+///
+/// Vertex-edges, edge-faces, and face-edges are always maintained. Relations
+/// which are not maintained are built in O(mesh) on first request and cached.
+/// Caches are then updated incrementally by insertions and local edits, and
+/// are only dropped by rollback() and remove_invalid_entities().
+template <bool VertexVertices, bool VertexFaces>
+struct relations {
+  static constexpr bool vertex_vertices = VertexVertices;
+  static constexpr bool vertex_faces = VertexFaces;
+};
+
+/// @brief Maintains all relations
+using all_relations = relations<true, true>;
+
+/// @brief Maintains only relations required to add and invalidate entities
+using minimal_relations = relations<false, false>;
+
+/// @brief View of the faces of a fracture
+///
+/// Faces of a fracture are a contiguous range of face indices, so that
+/// per-fracture work is proportional to the size of the fracture.
+template <typename Mesh>
+class fracture_view {
+ public:
+  fracture_view(const Mesh& mesh, fracture_index k, face_index first,
+                face_index last) noexcept
+      : mesh_{&mesh}, index_{k}, first_{first}, last_{last} {}
+
+  /// @brief Returns the whole mesh
+  const Mesh& mesh() const noexcept { return *mesh_; }
+
+  /// @brief Returns the fracture index
+  fracture_index index() const noexcept { return index_; }
+
+  /// @brief Returns the number of faces including invalid ones
+  std::size_t num_faces() const noexcept {
+    return last_.get() - first_.get();
+  }
+
+  /// @brief Returns the range of face indices of the fracture
+  auto faces() const noexcept {
+    return make_iterator_range(face_iterator{first_}, face_iterator{last_});
+  }
+
+  /// @brief Checks if a face belongs to the fracture
+  bool contains(face_index fi) const noexcept {
+    return first_ <= fi && fi < last_;
+  }
+
+ private:
+  const Mesh* mesh_;
+  fracture_index index_;
+  face_index first_;
+  face_index last_;
+};
+
+/// @brief Edges shared by faces of two fractures
+struct fracture_intersection {
+  /// The smaller fracture index
+  fracture_index first;
+  /// The larger fracture index
+  fracture_index second;
+  /// Shared edges in increasing order
+  std::vector<edge_index> edges;
+};
+
+/// @brief Mesh of fracture surfaces
+/// @tparam Point Point type
+/// @tparam Face Face type
+/// @tparam PointAllocator Allocator of points
+/// @tparam Relations Connectivity relations maintained by the mesh
 template <typename Point, typename Face,
-          typename PointAllocator = std::allocator<Point>>
+          typename PointAllocator = std::allocator<Point>,
+          typename Relations = all_relations>
 class fracture_mesh {
+  static_assert(sizeof(Face) == Face::num_vertices * sizeof(vertex_index) &&
+                    std::is_trivially_copyable_v<Face>,
+                "Face must be a padding-free array of vertex indices.");
+
  public:
+  using point_type = Point;
   using edge_type = undirected_edge;
+  using face_type = Face;
+  using relations_type = Relations;
 
   /// @brief Returns the number of vertices
   auto num_vertices() const noexcept { return vertices_.size(); }
@@ -52,38 +237,49 @@ class fracture_mesh {
   /// @brief Checks if a vertex is valid
   /// @param[in] i Vertex index
   /// @return Is a given vertex valid?
-  bool is_valid(vertex_index i) const noexcept { return is_valid_vertex_[i]; }
+  bool is_valid(vertex_index i) const noexcept {
+    return is_valid_vertex_[i] != 0;
+  }
 
   /// @brief Checks if an edge is valid
   /// @param[in] i Edge index
   /// @return Is a given edge valid?
-  bool is_valid(edge_index i) const noexcept { return is_valid_edge_[i]; }
+  bool is_valid(edge_index i) const noexcept { return is_valid_edge_[i] != 0; }
 
   /// @brief Checks if a face is valid
   /// @param[in] i Face index
   /// @return Is a given face valid?
-  bool is_valid(face_index i) const noexcept { return is_valid_face_[i]; }
+  bool is_valid(face_index i) const noexcept { return is_valid_face_[i] != 0; }
 
   /// @brief Find the edge index of a given edge
   /// @param[in] e Edge
   /// @return The index of a given edge. If the edge is not found, an invalid
   /// index is returned.
   edge_index find(const edge_type& e) const noexcept {
+    FMESH_INSTRUMENT(++counters_.edge_lookups);
     const auto& es = vertex_edges_[e.first];
-    for (auto&& ei : es)
+    for (auto&& ei : es) {
+      FMESH_INSTRUMENT(++counters_.edge_probes);
       if (edges_[ei] == e) return ei;
+    }
     return edge_index{};
   }
 
   /// @brief Find the face index of a given face
   /// @param[in] f Face
-  /// @return The index of a given face. If the face is not found, an invalid
-  /// index is returned.
+  /// @return The index of a given face. A valid face is returned if any,
+  /// since an invalidated face may have been added again. If the face is not
+  /// found, an invalid index is returned.
   face_index find(const Face& f) const noexcept {
-    const auto& fs = vertex_faces_[f[0]];
-    for (auto&& fi : fs)
-      if (faces_[fi] == f) return fi;
-    return face_index{};
+    FMESH_INSTRUMENT(++counters_.face_lookups);
+    face_index found;
+    this->for_each_vertex_face(f[0], [this, &f, &found](face_index fi) {
+      FMESH_INSTRUMENT(++counters_.face_probes);
+      if (!(faces_[fi] == f)) return;
+      if (!found.is_valid() || (!this->is_valid(found) && this->is_valid(fi)))
+        found = fi;
+    });
+    return found;
   }
 
   /// @brief Add a new vertex to mesh
@@ -107,15 +303,34 @@ class fracture_mesh {
   face_index add_face(const Face& f);
 
   /// @brief Add a new face to mesh
+  ///
+  /// A face constructed from given arguments is added by add_face(const Face&).
   template <typename... Args>
   face_index add_face(Args&&... args);
 
+  /// @brief Builds an empty mesh from vertices and faces at once
+  /// @param[in] points Vertices
+  /// @param[in] faces Distinct faces grouped by fracture
+  /// @param[in] fracture_offsets Faces of fracture k are in
+  /// [fracture_offsets[k], fracture_offsets[k + 1])
+  /// @throw std::logic_error If the mesh is not empty or a checkpoint is active
+  /// @throw std::invalid_argument If fracture_offsets are not nondecreasing
+  /// from 0 to the number of faces
+  ///
+  /// The mesh is the same as the one built by add_vertex() for each point and
+  /// add_face() for each face after set_current_fracture(), including indices
+  /// of edges and the change log, and the last fracture becomes current.
+  /// Instead of looking up edges face by face, face edges are grouped by their
+  /// vertices and all relations are built once in parallel.
+  void assign(const std::vector<Point>& points, const std::vector<Face>& faces,
+              const std::vector<std::size_t>& fracture_offsets);
+
   /// @brief Invalidate a given vertex
   /// @param[in] vi Vertex index to be invalidated
   ///
   /// This function invalidates a given vertex. In addition, it also invalidates
-  /// faces which contain the vertex. Isolated edges created by this operations
-  /// are also invalidated.
+  /// faces which contain the vertex. Isolated edges and vertices created by
+  /// this operations are also invalidated.
   void invalidate(vertex_index vi);
 
   /// @brief Invalidate a given face
@@ -125,6 +340,123 @@ class fracture_mesh {
   /// isolated vertices and edges which consist of the face.
   void invalidate(face_index fi);
 
+  /// @brief Moves a vertex
+  /// @param[in] vi Vertex index
+  /// @param[in] p New position
+  ///
+  /// Positions are not restored by rollback().
+  void move_vertex(vertex_index vi, const Point& p);
+
+  /// @name Local editing
+  ///
+  /// Local operators of triangular meshes which update all connectivity
+  /// relations in place in time proportional to the valence of the affected
+  /// vertices. Faces and edges are reused where possible, so edits leave no
+  /// invalid entities behind except those removed by collapse_edge(). Edges
+  /// shared by more than two faces are handled as branches.
+  ///
+  /// The operators throw std::logic_error if a checkpoint is active, because
+  /// the undo journal cannot record changes in place, and
+  /// std::invalid_argument if a given entity is invalid.
+  /// @{
+
+  /// @brief Inserts a vertex on an edge and splits all faces sharing it
+  /// @param[in] ei Edge index
+  /// @param[in] p Position of the new vertex
+  ///
+  /// Each face (a, b, c) on edge (a, b) is changed to (a, m, c) in place, and
+  /// a new face (m, b, c) is added with the same orientation.
+  topology_edit split_edge(edge_index ei, const Point& p);
+
+  /// @brief Inserts a vertex in a face and splits it into three faces
+  /// @param[in] fi Face index
+  /// @param[in] p Position of the new vertex
+  topology_edit split_face(face_index fi, const Point& p);
+
+  /// @brief Replaces an edge shared by two faces by the other diagonal of
+  /// their quadrilateral
+  /// @param[in] ei Edge index
+  /// @throw std::invalid_argument If the edge is not shared by exactly two
+  /// valid faces, or if the other diagonal is already an edge
+  topology_edit flip_edge(edge_index ei);
+
+  /// @brief Merges the second vertex of an edge into the first
+  /// @param[in] ei Edge index
+  /// @param[in] p New position of the first vertex
+  /// @throw std::invalid_argument If the collapse would change the topology,
+  /// i.e. the ends of the edge have common neighbors other than the opposite
+  /// vertices of its faces, or faces would be duplicated
+  ///
+  /// Faces sharing the edge are removed, and edges opposite to the removed
+  /// vertex in those faces are merged with edges of the first vertex.
+  topology_edit collapse_edge(edge_index ei, const Point& p);
+  /// @}
+
+  /// @name Fractures
+  ///
+  /// Each face belongs to a fracture. New faces are added to the current
+  /// fracture, which is fracture 0 unless add_fracture() or
+  /// set_current_fracture() is called. Faces of a fracture are contiguous as
+  /// long as faces are added fracture by fracture, and
+  /// remove_invalid_entities() groups them again otherwise. Fracture indices
+  /// of faces are not restored by rollback().
+  /// @{
+
+  /// @brief Starts a new fracture to which new faces are added
+  /// @return The index of the new fracture
+  fracture_index add_fracture() {
+    this->set_current_fracture(fracture_index{num_fractures_});
+    return current_fracture_;
+  }
+
+  /// @brief Sets the fracture to which new faces are added
+  void set_current_fracture(fracture_index k) {
+    this->extend_fractures(k);
+    current_fracture_ = k;
+  }
+
+  /// @brief Returns the fracture to which new faces are added
+  fracture_index current_fracture() const noexcept {
+    return current_fracture_;
+  }
+
+  /// @brief Returns the number of fractures
+  std::size_t num_fractures() const noexcept { return num_fractures_; }
+
+  /// @brief Returns the fracture of a face
+  fracture_index face_fracture(face_index fi) const noexcept {
+    return face_fractures_[fi];
+  }
+
+  /// @brief Moves a face to another fracture
+  ///
+  /// Faces of fractures are no longer contiguous until the next call of
+  /// remove_invalid_entities().
+  void set_face_fracture(face_index fi, fracture_index k);
+
+  /// @brief Checks if faces of each fracture are contiguous
+  bool are_fractures_contiguous() const noexcept {
+    return are_fractures_contiguous_;
+  }
+
+  /// @brief Returns the faces of a fracture
+  /// @throw std::logic_error If faces of fractures are not contiguous
+  fracture_view<fracture_mesh> fracture(fracture_index k) const {
+    if (!are_fractures_contiguous_) {
+      throw std::logic_error{
+          "fracture_mesh::fracture: faces are not grouped by fracture"};
+    }
+    const auto i = std::min(k.get(), num_fractures_);
+    const auto j = std::min(k.get() + 1, num_fractures_);
+    return {*this, k, face_index{fracture_offsets_[i]},
+            face_index{fracture_offsets_[j]}};
+  }
+
+  /// @brief Returns valid edges shared by valid faces of different fractures,
+  /// grouped by pairs of fractures in increasing order
+  std::vector<fracture_intersection> fracture_intersections() const;
+  /// @}
+
   /// @name Iterators
   /// @{
 
@@ -193,20 +525,345 @@ class fracture_mesh {
   const auto& face(face_index i) const noexcept { return faces_[i]; }
   /// @}
 
+  /// @name Raw storage
+  ///
+  /// Contiguous arrays of mesh entities for external solvers. Ranges consist
+  /// of raw pointers and include invalid entities. They are invalidated by
+  /// functions adding or removing mesh entities.
+  ///
+  /// Indices are standard-layout wrappers of std::size_t, and faces and edges
+  /// are arrays of indices without padding, which is checked by static
+  /// assertions.
+  /// @{
+
+  /// @brief Distance in bytes between consecutive points in points()
+  static constexpr std::size_t point_stride = sizeof(Point);
+
+  /// @brief Returns all points
+  auto points() const noexcept {
+    return make_iterator_range(vertices_.data(),
+                               vertices_.data() + vertices_.size());
+  }
+
+  /// @brief Returns vertices of all faces as a flat array
+  ///
+  /// The k-th vertex of face fi is at fi * Face::num_vertices + k.
+  auto face_vertex_array() const noexcept {
+    constexpr auto N = Face::num_vertices;
+    const auto first = faces_.empty() ? nullptr : faces_.data()->data();
+    return make_iterator_range(first, first + N * faces_.size());
+  }
+
+  /// @brief Returns both ends of all edges as a flat array
+  ///
+  /// The ends of edge ei are at 2 * ei and 2 * ei + 1.
+  auto edge_vertex_array() const noexcept {
+    const auto first = edges_.empty() ? nullptr : &edges_.data()->first;
+    return make_iterator_range(first, first + 2 * edges_.size());
+  }
+
+  /// @brief Returns validity flags of vertices, which are 1 if valid and 0 if
+  /// invalid
+  auto vertex_validity() const noexcept {
+    return make_iterator_range(is_valid_vertex_.data(),
+                               is_valid_vertex_.data() +
+                                   is_valid_vertex_.size());
+  }
+
+  /// @brief Returns validity flags of edges
+  auto edge_validity() const noexcept {
+    return make_iterator_range(is_valid_edge_.data(),
+                               is_valid_edge_.data() + is_valid_edge_.size());
+  }
+
+  /// @brief Returns validity flags of faces
+  auto face_validity() const noexcept {
+    return make_iterator_range(is_valid_face_.data(),
+                               is_valid_face_.data() + is_valid_face_.size());
+  }
+  /// @}
+
+  /// @name Connectivity
+  ///
+  /// Returned ranges also contain invalidated mesh entities. Circulators in
+  /// circulator.hpp visit valid mesh entities only.
+  /// @{
+
+  /// @brief Returns vertices connected to a given vertex by edges
+  /// @param[in] i Vertex index
+  ///
+  /// The k-th vertex is the other end of the k-th edge of vertex_edges().
+  /// If the relation is not maintained, it is cached on the first call.
+  /// Calls are not thread-safe in that case unless build_caches() is called
+  /// first.
+  auto vertex_vertices(vertex_index i) const
+      noexcept(Relations::vertex_vertices) {
+    if constexpr (!Relations::vertex_vertices) this->cache_vertex_vertices();
+    const auto& vs = vertex_vertices_[i];
+    return make_iterator_range(vs.data(), vs.data() + vs.size());
+  }
+
+  /// @brief Returns edges sharing a given vertex
+  /// @param[in] i Vertex index
+  auto vertex_edges(vertex_index i) const noexcept {
+    const auto& es = vertex_edges_[i];
+    return make_iterator_range(es.data(), es.data() + es.size());
+  }
+
+  /// @brief Returns faces sharing a given vertex
+  /// @param[in] i Vertex index
+  ///
+  /// If the relation is not maintained, it is cached on the first call.
+  /// Calls are not thread-safe in that case unless build_caches() is called
+  /// first.
+  auto vertex_faces(vertex_index i) const noexcept(Relations::vertex_faces) {
+    if constexpr (!Relations::vertex_faces) this->cache_vertex_faces();
+    const auto& fs = vertex_faces_[i];
+    return make_iterator_range(fs.data(), fs.data() + fs.size());
+  }
+
+  /// @brief Builds caches of relations which are not maintained
+  ///
+  /// Parallel algorithms call this function first, so that queries of
+  /// relations from several threads only read the caches.
+  void build_caches() const {
+    if constexpr (!Relations::vertex_vertices) this->cache_vertex_vertices();
+    if constexpr (!Relations::vertex_faces) this->cache_vertex_faces();
+  }
+
+  /// @brief Returns faces sharing a given edge
+  /// @param[in] i Edge index
+  auto edge_faces(edge_index i) const noexcept {
+    const auto& fs = edge_faces_[i];
+    return make_iterator_range(fs.data(), fs.data() + fs.size());
+  }
+
+  /// @brief Returns edges of a given face in the order of Face::to_edges()
+  /// @param[in] i Face index
+  auto face_edges(face_index i) const noexcept {
+    const auto& es = face_edges_[i];
+    return make_iterator_range(es.data(), es.data() + es.size());
+  }
+  /// @}
+
   /// @brief Checks if this mesh has invalid mesh entities (vertex, edge, or
   /// face)
   bool has_invalid_entities() const noexcept {
     return has_invalid_vertices_ || has_invalid_edges_ || has_invalid_faces_;
   }
 
+  /// @name Capacity
+  /// @{
+
+  /// @brief Reserves storage for mesh entities
+  /// @param[in] nv The number of vertices
+  /// @param[in] ne The number of edges
+  /// @param[in] nf The number of faces
+  /// @param[in] valence Expected number of edges per vertex. If nonzero,
+  /// connectivity lists of each new vertex are allocated with this capacity
+  /// at once instead of growing on every face insertion.
+  void reserve(std::size_t nv, std::size_t ne, std::size_t nf,
+               std::size_t valence = 0);
+
+  /// @brief Releases unused capacity of all arrays and connectivity lists
+  void shrink_to_fit();
+  /// @}
+
+  /// @name Checkpoints
+  ///
+  /// A checkpoint records subsequent topological changes by add_vertex(),
+  /// add_face(), and invalidate() in an undo journal, so that they can be
+  /// rolled back in time proportional to the number of changes. Checkpoints
+  /// can be nested. Property arrays held outside the mesh are not affected.
+  /// @{
+
+  /// @brief Starts recording changes
+  void checkpoint();
+
+  /// @brief Reverts all changes since the last checkpoint and removes it
+  void rollback();
+
+  /// @brief Removes the last checkpoint and keeps changes since then
+  ///
+  /// Changes are still reverted by rollback() to an outer checkpoint.
+  void release_checkpoint();
+
+  /// @brief Returns the number of active checkpoints
+  std::size_t num_checkpoints() const noexcept { return checkpoints_.size(); }
+  /// @}
+
+  /// @name Change tracking
+  ///
+  /// The epoch counts changes of the mesh. While tracking is enabled, every
+  /// change is appended to a log, so that derived data can be updated from
+  /// the changes since the epoch at which it was built. Each consumer keeps
+  /// its own epoch, and the log is trimmed by discard_changes() once all
+  /// consumers have caught up. Tracking is disabled by default.
+  /// @{
+
+  /// @brief Enables or disables recording changes
+  ///
+  /// Disabling tracking discards the log.
+  void track_changes(bool enable);
+
+  /// @brief Checks if changes are recorded
+  bool is_tracking_changes() const noexcept { return is_tracking_changes_; }
+
+  /// @brief Returns the current epoch
+  std::uint64_t epoch() const noexcept { return epoch_; }
+
+  /// @brief Checks if changes since an epoch are in the log
+  bool has_changes_since(std::uint64_t epoch) const noexcept {
+    return first_logged_epoch_ <= epoch && epoch <= epoch_;
+  }
+
+  /// @brief Returns changes since an epoch in the order of occurrence
+  /// @throw std::out_of_range If the changes are not in the log
+  auto changes_since(std::uint64_t epoch) const {
+    this->check_change_log(epoch);
+    const auto first = changes_.data() + (epoch - first_logged_epoch_);
+    return make_iterator_range(first, changes_.data() + changes_.size());
+  }
+
+  /// @brief Returns entities changed since an epoch without duplicates
+  /// @throw std::out_of_range If the changes are not in the log
+  change_set changed_since(std::uint64_t epoch) const;
+
+  /// @brief Discards changes before an epoch
+  void discard_changes(std::uint64_t epoch);
+  /// @}
+
+  /// @name Instrumentation
+  /// @{
+
+  /// @brief Returns a snapshot of counters of hot-path operations
+  ///
+  /// Counters stay zero unless FMESH_ENABLE_INSTRUMENTATION is defined. They
+  /// are atomic, so const queries may be called from several threads.
+  mesh_counters counters() const noexcept {
+#ifdef FMESH_ENABLE_INSTRUMENTATION
+    return counters_.load();
+#else
+    return {};
+#endif
+  }
+
+  /// @brief Resets counters of hot-path operations
+  void reset_counters() noexcept { FMESH_INSTRUMENT(counters_.reset()); }
+
+  /// @brief Returns memory used by each array of mesh entities and
+  /// connectivity
+  std::vector<memory_record> memory_usage() const {
+    return {measure_memory("vertices", vertices_),
+            measure_memory("edges", edges_),
+            measure_memory("faces", faces_),
+            measure_nested_memory("vertex_vertices", vertex_vertices_),
+            measure_nested_memory("vertex_edges", vertex_edges_),
+            measure_nested_memory("vertex_faces", vertex_faces_),
+            measure_nested_memory("edge_faces", edge_faces_),
+            measure_nested_memory("face_edges", face_edges_),
+            measure_memory("is_valid_vertex", is_valid_vertex_),
+            measure_memory("is_valid_edge", is_valid_edge_),
+            measure_memory("is_valid_face", is_valid_face_),
+            measure_memory("face_fractures", face_fractures_),
+            measure_memory("changes", changes_)};
+  }
+  /// @}
+
   /// @brief Removes invalid mesh entities from mesh
-  void remove_invalid_entities();
+  /// @return Maps from old to new indices
+  /// @throw std::logic_error If a checkpoint is active
+  ///
+  /// Remaining mesh entities keep their relative order.
+  entity_remap remove_invalid_entities();
 
  private:
+  /// @brief Add connectivity data of a new vertex
+  /// @param[in] vi The index of a new vertex
+  void add_vertex_connectivity(const vertex_index vi);
+
   /// @brief Update face connectivity data
   /// @param[in] fi The index of a new face
   void update_face_connectivity(const face_index fi) noexcept;
 
+  /// @name Helpers of local editing
+  /// @{
+
+  /// @brief Throws if local editing is not allowed
+  void check_editable(const char* name) const;
+
+  /// @brief Appends a face without checking duplicates
+  face_index append_face(const Face& f, fracture_index k);
+
+  /// @brief Removes a face from connectivity lists of its vertices and edges
+  void detach_face(const face_index fi);
+
+  /// @brief Moves an edge to new ends, updating lists of old and new ends
+  void move_edge(const edge_index ei, const vertex_index v1,
+                 const vertex_index v2);
+
+  /// @brief Appends invalid edges of a face which are used again once the
+  /// face is connected
+  void find_reused_edges(const Face& f, std::vector<edge_index>& es) const;
+
+  /// @brief Returns valid faces sharing an edge
+  std::vector<face_index> valid_faces(const edge_index ei) const;
+
+  /// @brief Returns valid faces sharing a vertex
+  std::vector<face_index> valid_faces(const vertex_index vi) const;
+  /// @}
+
+  /// @brief Maps valid faces to new indices grouped by fracture and updates
+  /// the ranges of fractures accordingly
+  /// @return The number of valid faces
+  std::size_t make_face_map(face_property<face_index>& map);
+
+  /// @brief Makes sure that a fracture index is less than num_fractures()
+  void extend_fractures(fracture_index k) {
+    if (k.get() < num_fractures_) return;
+    num_fractures_ = k.get() + 1;
+    fracture_offsets_.resize(num_fractures_ + 1, fracture_offsets_.back());
+  }
+
+  /// @brief Appends a change to the log if tracking is enabled
+  void log_change(mesh_change::entity type, mesh_change::kind change,
+                  std::size_t i) {
+    if (is_tracking_changes_) {
+      this->append(changes_, mesh_change{type, change, i});
+    } else {
+      first_logged_epoch_ = epoch_ + 1;
+    }
+    ++epoch_;
+  }
+
+  /// @brief Throws if changes since an epoch are not in the log
+  void check_change_log(std::uint64_t epoch) const {
+    if (!this->has_changes_since(epoch)) {
+      throw std::out_of_range{
+          "fracture_mesh: changes since the epoch are not in the log"};
+    }
+  }
+
+  /// @brief Records a change if it must be reverted by rollback()
+  /// @param[in] type The type of a change
+  /// @param[in] i The index of a changed entity
+  void record(detail::journal_entry::kind type, std::size_t i);
+
+  /// @name Validity setters recording changes
+  /// @{
+  void set_valid(vertex_index vi, bool valid);
+  void set_valid(edge_index ei, bool valid);
+  void set_valid(face_index fi, bool valid);
+  /// @}
+
+  /// @brief Appends a value to an array and counts its reallocation
+  template <typename Array, typename... Args>
+  void append(Array& a, Args&&... args) {
+    FMESH_INSTRUMENT(const auto capacity = a.capacity());
+    a.emplace_back(std::forward<Args>(args)...);
+    FMESH_INSTRUMENT(if (a.capacity() != capacity) ++counters_.reallocations);
+  }
+
   /// @brief Checks if a given edge is isolated
   /// @param[in] ei Edge index
   ///
@@ -224,12 +881,46 @@ class fracture_mesh {
   ///
   /// Isolated vertices do not have any valid faces connected to themselves.
   bool is_isolated(const vertex_index vi) const noexcept {
-    const auto& fs = vertex_faces_[vi];
-    const auto num_valid_faces =
-        std::count_if(fs.begin(), fs.end(),
-                      [this](const auto fi) { return this->is_valid(fi); });
-    return num_valid_faces == 0;
+    bool has_valid_face = false;
+    this->for_each_vertex_face(vi, [this, &has_valid_face](face_index fi) {
+      has_valid_face = has_valid_face || this->is_valid(fi);
+    });
+    return !has_valid_face;
+  }
+
+  /// @brief Calls a function for each face sharing a given vertex
+  ///
+  /// If vertex-faces are not maintained, faces are found through edges of the
+  /// vertex, and each face is visited once for each of its two edges sharing
+  /// the vertex.
+  template <typename Function>
+  void for_each_vertex_face(const vertex_index vi, Function&& f) const {
+    if constexpr (Relations::vertex_faces) {
+      for (auto&& fi : vertex_faces_[vi]) f(fi);
+    } else {
+      for (auto&& ei : vertex_edges_[vi])
+        for (auto&& fi : edge_faces_[ei]) f(fi);
+    }
+  }
+
+  /// @name Caches of relations which are not maintained
+  /// @{
+  void build_vertex_vertices() const;
+  void cache_vertex_vertices() const;
+  void cache_vertex_faces() const;
+  void clear_caches() noexcept {
+    has_vertex_vertices_cache_ = false;
+    has_vertex_faces_cache_ = false;
   }
+  /// @brief Are vertex-vertices maintained or cached?
+  bool has_vertex_vertices() const noexcept {
+    return Relations::vertex_vertices || has_vertex_vertices_cache_;
+  }
+  /// @brief Are vertex-faces maintained or cached?
+  bool has_vertex_faces() const noexcept {
+    return Relations::vertex_faces || has_vertex_faces_cache_;
+  }
+  /// @}
 
   /// @name Mesh entities
   /// @{
@@ -240,9 +931,9 @@ class fracture_mesh {
 
   /// @name Mesh connectivity
   /// @{
-  vertex_property<std::vector<vertex_index>> vertex_vertices_;
+  mutable vertex_property<std::vector<vertex_index>> vertex_vertices_;
   vertex_property<std::vector<edge_index>> vertex_edges_;
-  vertex_property<std::vector<face_index>> vertex_faces_;
+  mutable vertex_property<std::vector<face_index>> vertex_faces_;
   edge_property<std::vector<face_index>> edge_faces_;
   face_property<std::vector<edge_index>> face_edges_;
   /// @}
@@ -253,9 +944,9 @@ class fracture_mesh {
   /// Mesh entities can be invalidated.
   /// Call remove_invalid_entities() if you really need to remove them.
   /// @{
-  vertex_property<bool> is_valid_vertex_;
-  edge_property<bool> is_valid_edge_;
-  face_property<bool> is_valid_face_;
+  vertex_property<std::uint8_t> is_valid_vertex_;
+  edge_property<std::uint8_t> is_valid_edge_;
+  face_property<std::uint8_t> is_valid_face_;
   /// @}
 
   /// @name Flags to check if there are any invalid mesh entities.
@@ -264,155 +955,1244 @@ class fracture_mesh {
   bool has_invalid_edges_ = false;
   bool has_invalid_faces_ = false;
   /// @}
+
+  /// @name Are caches of relations which are not maintained up to date?
+  /// @{
+  mutable bool has_vertex_vertices_cache_ = false;
+  mutable bool has_vertex_faces_cache_ = false;
+  /// @}
+
+  /// Expected number of edges per vertex given by reserve()
+  std::size_t valence_ = 0;
+
+  /// @name Fractures
+  /// @{
+  face_property<fracture_index> face_fractures_;
+  fracture_index current_fracture_{0};
+  std::size_t num_fractures_ = 1;
+  /// Faces of fracture k are in [offsets[k], offsets[k + 1]) if contiguous.
+  std::vector<std::size_t> fracture_offsets_ = {0, 0};
+  bool are_fractures_contiguous_ = true;
+  /// @}
+
+  /// @name Undo journal
+  /// @{
+  std::vector<detail::journal_entry> journal_;
+  std::vector<detail::checkpoint_mark> checkpoints_;
+  /// @}
+
+  /// @name Change log
+  /// @{
+  std::vector<mesh_change> changes_;
+  std::uint64_t epoch_ = 0;
+  /// Epoch of the first change in the log
+  std::uint64_t first_logged_epoch_ = 0;
+  bool is_tracking_changes_ = false;
+  /// @}
+
+#ifdef FMESH_ENABLE_INSTRUMENTATION
+  mutable detail::atomic_mesh_counters counters_;
+#endif
 };
 
-template <typename Point, typename Face, typename PointAllocator>
-vertex_index fracture_mesh<Point, Face, PointAllocator>::add_vertex(
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+vertex_index fracture_mesh<Point, Face, PointAllocator, Relations>::add_vertex(
     const Point& p) {
   const vertex_index vi{vertices_.size()};
-  vertices_.push_back(p);
-  const auto n = vertices_.size();
-  vertex_vertices_.resize(n);
-  vertex_edges_.resize(n);
-  vertex_faces_.resize(n);
-  is_valid_vertex_.push_back(true);
+  FMESH_INSTRUMENT(++counters_.vertex_insertions);
+  this->append(vertices_, p);
+  this->add_vertex_connectivity(vi);
   return vi;
 }
 
-template <typename Point, typename Face, typename PointAllocator>
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
 template <typename... Args>
-vertex_index fracture_mesh<Point, Face, PointAllocator>::add_vertex(
+vertex_index fracture_mesh<Point, Face, PointAllocator, Relations>::add_vertex(
     Args&&... args) {
   const vertex_index vi{vertices_.size()};
-  vertices_.emplace_back(std::forward<Args>(args)...);
-  const auto n = vertices_.size();
-  vertex_vertices_.resize(n);
-  vertex_edges_.resize(n);
-  vertex_faces_.resize(n);
-  is_valid_vertex_.push_back(true);
+  FMESH_INSTRUMENT(++counters_.vertex_insertions);
+  this->append(vertices_, std::forward<Args>(args)...);
+  this->add_vertex_connectivity(vi);
   return vi;
 }
 
-template <typename Point, typename Face, typename PointAllocator>
-face_index fracture_mesh<Point, Face, PointAllocator>::add_face(const Face& f) {
-  if (this->find(f).is_valid()) {
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+face_index fracture_mesh<Point, Face, PointAllocator, Relations>::add_face(
+    const Face& f) {
+  const auto fj = this->find(f);
+  if (fj.is_valid() && this->is_valid(fj)) {
     std::cerr << "Warning: face [" << f << "] is already registered.\n";
     return face_index{};
   }
 
-  const face_index fi{faces_.size()};
-  faces_.push_back(f);
-  face_edges_.resize(faces_.size());
-  is_valid_face_.push_back(true);
-  this->update_face_connectivity(fi);
-  return fi;
+  return this->append_face(f, current_fracture_);
 }
 
-template <typename Point, typename Face, typename PointAllocator>
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
 template <typename... Args>
-face_index fracture_mesh<Point, Face, PointAllocator>::add_face(
+face_index fracture_mesh<Point, Face, PointAllocator, Relations>::add_face(
     Args&&... args) {
-  const face_index fi{faces_.size()};
-  faces_.emplace_back(std::forward<Args>(args)...);
-  face_edges_.resize(faces_.size());
-  is_valid_face_.push_back(true);
-  this->update_face_connectivity(fi);
-  return fi;
+  const Face f(std::forward<Args>(args)...);
+  return this->add_face(f);
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::assign(
+    const std::vector<Point>& points, const std::vector<Face>& faces,
+    const std::vector<std::size_t>& fracture_offsets) {
+  FMESH_SCOPED_TIMER("fracture_mesh::assign");
+  this->check_editable("assign");
+  if (!vertices_.empty() || !faces_.empty()) {
+    throw std::logic_error{"fracture_mesh::assign: the mesh is not empty"};
+  }
+  if (fracture_offsets.size() < 2 || fracture_offsets.front() != 0 ||
+      fracture_offsets.back() != faces.size() ||
+      !std::is_sorted(fracture_offsets.begin(), fracture_offsets.end())) {
+    throw std::invalid_argument{
+        "fracture_mesh::assign: fracture_offsets must be nondecreasing from 0 "
+        "to the number of faces"};
+  }
+
+  constexpr auto N = Face::num_vertices;
+  constexpr std::size_t grain = 4096;
+  const auto nv = points.size();
+  const auto nf = faces.size();
+  const auto at = [](auto& array, std::size_t i) {
+    return array.begin() + static_cast<std::ptrdiff_t>(i);
+  };
+  // Copies groups into lists in parallel.
+  const auto assign_lists = [&at](auto& lists, const auto& groups) {
+    const auto& offsets = groups.offsets;
+    detail::for_each_chunk(
+        lists.size(), grain, [&](std::size_t begin, std::size_t end) {
+          for (auto i = begin; i < end; ++i) {
+            at(lists, i)->assign(at(groups.values, offsets[i]),
+                                 at(groups.values, offsets[i + 1]));
+          }
+        });
+  };
+  this->clear_caches();
+
+  vertices_.resize(nv);
+  faces_.resize(nf);
+  detail::for_each_chunk(nv, grain, [&](std::size_t begin, std::size_t end) {
+    std::copy(at(points, begin), at(points, end), at(vertices_, begin));
+  });
+  detail::for_each_chunk(nf, grain, [&](std::size_t begin, std::size_t end) {
+    std::copy(at(faces, begin), at(faces, end), at(faces_, begin));
+  });
+
+  // Edge j of face f is in slot N * f + j. Slots are grouped by the smaller
+  // vertex of their edges and sorted by the larger one, so that slots of an
+  // edge are contiguous and in face order.
+  const auto slots = detail::group_values<std::pair<vertex_index, std::size_t>>(
+      nv, nf, [&faces](std::size_t f, auto&& add) {
+        const auto es = faces[f].to_edges();
+        for (std::size_t j = 0; j < N; ++j) {
+          const auto [v1, v2] = std::minmax(es[j].first, es[j].second);
+          add(static_cast<std::size_t>(v1), std::pair{v2, N * f + j});
+        }
+      });
+  // Calls f(first, last) for the range of slots of each edge.
+  const auto for_each_edge = [&slots, nv](auto&& f) {
+    const auto& values = slots.values;
+    detail::for_each_chunk(nv, grain, [&](std::size_t begin, std::size_t end) {
+      for (auto v = begin; v < end; ++v) {
+        const auto last = slots.offsets[v + 1];
+        for (auto j = slots.offsets[v]; j < last;) {
+          auto k = j + 1;
+          while (k < last && values[k].first == values[j].first) ++k;
+          f(j, k);
+          j = k;
+        }
+      }
+    });
+  };
+
+  // add_face() numbers edges in the order of their first slots.
+  std::vector<std::uint8_t> is_first(N * nf, 0);
+  for_each_edge([&is_first, &slots](std::size_t first, std::size_t) {
+    is_first[slots.values[first].second] = 1;
+  });
+  const auto ranks = detail::count_flags(is_first);
+  const auto ne = ranks.back();
+  edges_.resize(ne);
+  edge_faces_.resize(ne);
+  face_edges_.resize(nf);
+  detail::for_each_chunk(nf, grain, [this](std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end; ++i) face_edges_[face_index{i}].resize(N);
+  });
+  for_each_edge([&](std::size_t first, std::size_t last) {
+    const auto s = slots.values[first].second;
+    const edge_index ei{ranks[s]};
+    edges_[ei] = faces[s / N].to_edges()[s % N];
+    auto& fs = edge_faces_[ei];
+    fs.reserve(std::max<std::size_t>(last - first, 2));
+    for (auto j = first; j < last; ++j) {
+      const auto t = slots.values[j].second;
+      fs.emplace_back(t / N);
+      face_edges_[face_index{t / N}][t % N] = ei;
+    }
+  });
+
+  // Lists of a vertex are in the order of creation of edges and faces.
+  vertex_edges_.resize(nv);
+  assign_lists(vertex_edges_,
+               detail::group_values<edge_index>(
+                   nv, ne, [this](std::size_t i, auto&& add) {
+                     const edge_index ei{i};
+                     add(static_cast<std::size_t>(edges_[ei].first), ei);
+                     add(static_cast<std::size_t>(edges_[ei].second), ei);
+                   }));
+  if constexpr (Relations::vertex_vertices) {
+    vertex_vertices_.resize(nv);
+    detail::for_each_chunk(nv, grain, [this](std::size_t begin,
+                                             std::size_t end) {
+      for (vertex_index vi{begin}; vi < vertex_index{end}; ++vi) {
+        auto& vs = vertex_vertices_[vi];
+        vs.reserve(vertex_edges_[vi].size());
+        for (auto&& ei : vertex_edges_[vi]) {
+          const auto& e = edges_[ei];
+          vs.push_back(e.first == vi ? e.second : e.first);
+        }
+      }
+    });
+  }
+  if constexpr (Relations::vertex_faces) {
+    vertex_faces_.resize(nv);
+    assign_lists(vertex_faces_,
+                 detail::group_values<face_index>(
+                     nv, nf, [&faces](std::size_t i, auto&& add) {
+                       for (auto&& vi : faces[i])
+                         add(static_cast<std::size_t>(vi), face_index{i});
+                     }));
+  }
+
+  is_valid_vertex_.resize(nv, 1);
+  is_valid_edge_.resize(ne, 1);
+  is_valid_face_.resize(nf, 1);
+  has_invalid_vertices_ = false;
+  has_invalid_edges_ = false;
+  has_invalid_faces_ = false;
+
+  const fracture_index last{fracture_offsets.size() - 2};
+  this->extend_fractures(last);
+  std::copy(fracture_offsets.begin(), fracture_offsets.end(),
+            fracture_offsets_.begin());
+  std::fill(at(fracture_offsets_, fracture_offsets.size()),
+            fracture_offsets_.end(), nf);
+  are_fractures_contiguous_ = true;
+  current_fracture_ = last;
+  face_fractures_.resize(nf);
+  detail::for_each_chunk(nf, grain, [&](std::size_t begin, std::size_t end) {
+    auto k = static_cast<std::size_t>(
+        std::upper_bound(fracture_offsets.begin(), fracture_offsets.end(),
+                         begin) -
+        fracture_offsets.begin() - 1);
+    for (auto i = begin; i < end; ++i) {
+      while (fracture_offsets[k + 1] <= i) ++k;
+      face_fractures_[face_index{i}] = fracture_index{k};
+    }
+  });
+
+  FMESH_INSTRUMENT(counters_.vertex_insertions += nv);
+  FMESH_INSTRUMENT(counters_.edge_insertions += ne);
+  FMESH_INSTRUMENT(counters_.face_insertions += nf);
+  // Changes are logged in the order of add_vertex() and add_face().
+  if (is_tracking_changes_) {
+    changes_.reserve(changes_.size() + nv + ne + nf);
+    for (std::size_t i = 0; i < nv; ++i)
+      this->log_change(mesh_change::entity::vertex, mesh_change::kind::created,
+                       i);
+    for (std::size_t i = 0; i < nf; ++i) {
+      for (auto s = N * i; s < N * (i + 1); ++s) {
+        if (!is_first[s]) continue;
+        this->log_change(mesh_change::entity::edge, mesh_change::kind::created,
+                         ranks[s]);
+      }
+      this->log_change(mesh_change::entity::face, mesh_change::kind::created,
+                       i);
+    }
+  } else if (nv + nf > 0) {
+    epoch_ += nv + ne + nf;
+    first_logged_epoch_ = epoch_;
+  }
 }
 
-template <typename Point, typename Face, typename PointAllocator>
-void fracture_mesh<Point, Face, PointAllocator>::invalidate(vertex_index vi) {
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::invalidate(
+    vertex_index vi) {
+  FMESH_INSTRUMENT(++counters_.invalidations);
   has_invalid_vertices_ = true;
-  is_valid_vertex_[vi] = false;
+  this->set_valid(vi, false);
 
   // Invalidate all edges connected to the vertex
   const auto& es = vertex_edges_[vi];
-  for (auto&& ei : es) is_valid_edge_[ei] = false;
+  for (auto&& ei : es) this->set_valid(ei, false);
+  if (!es.empty()) has_invalid_edges_ = true;
 
   // Invalidate all faces connected to the vertex
-  const auto& fs = vertex_faces_[vi];
-  for (auto&& fi : fs) is_valid_face_[fi] = false;
+  this->for_each_vertex_face(vi, [this](face_index fi) {
+    this->set_valid(fi, false);
+    has_invalid_faces_ = true;
+  });
 
-  // Invalidate isolated edges
-  for (auto&& fi : fs) {
+  // Invalidate isolated edges and vertices
+  this->for_each_vertex_face(vi, [this](face_index fi) {
     const auto& es = face_edges_[fi];
     for (auto&& ei : es) {
-      if (this->is_valid(ei) && this->is_isolated(ei))
-        is_valid_edge_[ei] = false;
+      if (this->is_valid(ei) && this->is_isolated(ei)) {
+        this->set_valid(ei, false);
+        has_invalid_edges_ = true;
+      }
     }
-  }
+    for (auto&& vj : faces_[fi]) {
+      if (this->is_valid(vj) && this->is_isolated(vj)) {
+        this->set_valid(vj, false);
+      }
+    }
+  });
 }
 
-template <typename Point, typename Face, typename PointAllocator>
-void fracture_mesh<Point, Face, PointAllocator>::invalidate(face_index fi) {
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::invalidate(
+    face_index fi) {
+  FMESH_INSTRUMENT(++counters_.invalidations);
   has_invalid_faces_ = true;
-  is_valid_face_[fi] = false;
+  this->set_valid(fi, false);
 
   // Invalidate isolated edges
   const auto& es = face_edges_[fi];
   for (auto&& ei : es) {
-    if (this->is_valid(ei) && this->is_isolated(ei)) is_valid_edge_[ei] = false;
+    if (this->is_valid(ei) && this->is_isolated(ei)) {
+      this->set_valid(ei, false);
+      has_invalid_edges_ = true;
+    }
   }
 
   // Invalidate isolated vertices
   const auto& f = faces_[fi];
   for (auto&& vi : f) {
-    if (this->is_valid(vi) && this->is_isolated(vi))
-      is_valid_vertex_[vi] = false;
+    if (this->is_valid(vi) && this->is_isolated(vi)) {
+      this->set_valid(vi, false);
+      has_invalid_vertices_ = true;
+    }
+  }
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::move_vertex(
+    vertex_index vi, const Point& p) {
+  vertices_[vi] = p;
+  this->log_change(mesh_change::entity::vertex, mesh_change::kind::modified,
+                   static_cast<std::size_t>(vi));
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+topology_edit
+fracture_mesh<Point, Face, PointAllocator, Relations>::split_edge(
+    edge_index ei, const Point& p) {
+  static_assert(Face::num_vertices == 3,
+                "split_edge supports triangular meshes only");
+  this->check_editable("split_edge");
+  if (!this->is_valid(ei)) {
+    throw std::invalid_argument{"fracture_mesh::split_edge: invalid edge"};
+  }
+
+  topology_edit edit;
+  const auto [a, b] = edges_[ei];
+  const auto fs = this->valid_faces(ei);
+  const auto m = this->add_vertex(p);
+  edit.vertex = m;
+  const auto ne = edges_.size();
+
+  for (auto&& fi : fs) this->detach_face(fi);
+  if (edge_faces_[ei].empty()) {
+    this->move_edge(ei, a, m);
+    edit.modified_edges.push_back(ei);
+  } else {
+    // Invalid faces still refer to the edge.
+    this->set_valid(ei, false);
+    has_invalid_edges_ = true;
+    edit.removed_edges.push_back(ei);
+  }
+
+  for (auto&& fi : fs) {
+    auto f = faces_[fi];
+    auto g = f;
+    for (auto&& vi : f)
+      if (vi == b) vi = m;
+    for (auto&& vi : g)
+      if (vi == a) vi = m;
+    faces_[fi] = f;
+    this->find_reused_edges(f, edit.modified_edges);
+    this->update_face_connectivity(fi);
+    edit.modified_faces.push_back(fi);
+    this->find_reused_edges(g, edit.modified_edges);
+    edit.new_faces.push_back({this->append_face(g, face_fractures_[fi]), fi});
+  }
+  for (edge_index ej{ne}; ej < edge_index{edges_.size()}; ++ej)
+    edit.new_edges.push_back(ej);
+  return edit;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+topology_edit
+fracture_mesh<Point, Face, PointAllocator, Relations>::split_face(
+    face_index fi, const Point& p) {
+  static_assert(Face::num_vertices == 3,
+                "split_face supports triangular meshes only");
+  this->check_editable("split_face");
+  if (!this->is_valid(fi)) {
+    throw std::invalid_argument{"fracture_mesh::split_face: invalid face"};
+  }
+
+  topology_edit edit;
+  const auto f = faces_[fi];
+  const auto m = this->add_vertex(p);
+  edit.vertex = m;
+  const auto ne = edges_.size();
+
+  this->detach_face(fi);
+  faces_[fi] = Face(f[0], f[1], m);
+  this->update_face_connectivity(fi);
+  edit.modified_faces.push_back(fi);
+  const auto k = face_fractures_[fi];
+  edit.new_faces.push_back({this->append_face(Face(f[1], f[2], m), k), fi});
+  edit.new_faces.push_back({this->append_face(Face(f[2], f[0], m), k), fi});
+  for (edge_index ej{ne}; ej < edge_index{edges_.size()}; ++ej)
+    edit.new_edges.push_back(ej);
+  return edit;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+topology_edit
+fracture_mesh<Point, Face, PointAllocator, Relations>::flip_edge(
+    edge_index ei) {
+  static_assert(Face::num_vertices == 3,
+                "flip_edge supports triangular meshes only");
+  this->check_editable("flip_edge");
+  if (!this->is_valid(ei)) {
+    throw std::invalid_argument{"fracture_mesh::flip_edge: invalid edge"};
+  }
+  const auto fs = this->valid_faces(ei);
+  if (fs.size() != 2) {
+    throw std::invalid_argument{
+        "fracture_mesh::flip_edge: edge must be shared by two valid faces"};
+  }
+
+  // Orients the edge as in the first face (a, b, c).
+  const auto& f1 = faces_[fs[0]];
+  std::size_t k = 0;
+  while (edge_type{f1[k], f1[(k + 1) % 3]} != edges_[ei]) ++k;
+  const auto a = f1[k];
+  const auto b = f1[(k + 1) % 3];
+  const auto c = f1[(k + 2) % 3];
+  vertex_index d;
+  for (auto&& vi : faces_[fs[1]])
+    if (vi != a && vi != b) d = vi;
+
+  const auto ej = this->find(edge_type{c, d});
+  if (c == d || (ej.is_valid() && this->is_valid(ej))) {
+    throw std::invalid_argument{
+        "fracture_mesh::flip_edge: flipped edge already exists"};
+  }
+
+  topology_edit edit;
+  const auto ne = edges_.size();
+  for (auto&& fi : fs) this->detach_face(fi);
+  if (edge_faces_[ei].empty() && !ej.is_valid()) {
+    this->move_edge(ei, c, d);
+    edit.modified_edges.push_back(ei);
+  } else {
+    this->set_valid(ei, false);
+    has_invalid_edges_ = true;
+    edit.removed_edges.push_back(ei);
+  }
+
+  faces_[fs[0]] = Face(a, d, c);
+  faces_[fs[1]] = Face(d, b, c);
+  for (auto&& fi : fs) {
+    this->find_reused_edges(faces_[fi], edit.modified_edges);
+    this->update_face_connectivity(fi);
+    edit.modified_faces.push_back(fi);
+  }
+  for (edge_index el{ne}; el < edge_index{edges_.size()}; ++el)
+    edit.new_edges.push_back(el);
+  return edit;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+topology_edit
+fracture_mesh<Point, Face, PointAllocator, Relations>::collapse_edge(
+    edge_index ei, const Point& p) {
+  static_assert(Face::num_vertices == 3,
+                "collapse_edge supports triangular meshes only");
+  this->check_editable("collapse_edge");
+  if (!this->is_valid(ei)) {
+    throw std::invalid_argument{"fracture_mesh::collapse_edge: invalid edge"};
+  }
+
+  const auto [a, b] = edges_[ei];
+  const auto removed = this->valid_faces(ei);
+  std::vector<vertex_index> opposite;
+  for (auto&& fi : removed)
+    for (auto&& vi : faces_[fi])
+      if (vi != a && vi != b) opposite.push_back(vi);
+  std::sort(opposite.begin(), opposite.end());
+
+  // Link condition: common neighbors are exactly the opposite vertices.
+  const auto neighbors = [this](vertex_index vi) {
+    std::vector<vertex_index> vs;
+    for (auto&& ej : vertex_edges_[vi]) {
+      if (!this->is_valid(ej)) continue;
+      const auto& e = edges_[ej];
+      vs.push_back(e.first == vi ? e.second : e.first);
+    }
+    std::sort(vs.begin(), vs.end());
+    return vs;
+  };
+  const auto na = neighbors(a);
+  const auto nb = neighbors(b);
+  std::vector<vertex_index> common;
+  std::set_intersection(na.begin(), na.end(), nb.begin(), nb.end(),
+                        std::back_inserter(common));
+  if (common != opposite) {
+    throw std::invalid_argument{
+        "fracture_mesh::collapse_edge: collapse changes topology"};
+  }
+
+  const auto sorted = [](Face f) {
+    std::sort(f.begin(), f.end());
+    return f;
+  };
+  auto moved = this->valid_faces(b);
+  moved.erase(std::remove_if(moved.begin(), moved.end(),
+                             [this, a](face_index fi) {
+                               return faces_[fi].contains(a);
+                             }),
+              moved.end());
+  const auto faces_a = this->valid_faces(a);
+  for (auto&& fi : moved) {
+    auto f = faces_[fi];
+    for (auto&& vi : f)
+      if (vi == b) vi = a;
+    for (auto&& fj : faces_a) {
+      if (sorted(faces_[fj]) == sorted(f)) {
+        throw std::invalid_argument{
+            "fracture_mesh::collapse_edge: collapse duplicates faces"};
+      }
+    }
+  }
+
+  topology_edit edit;
+  edit.vertex = b;
+  this->move_vertex(a, p);
+  for (auto&& fi : removed) {
+    this->set_valid(fi, false);
+    has_invalid_faces_ = true;
+    edit.removed_faces.push_back(fi);
+  }
+  for (auto&& fi : moved) this->detach_face(fi);
+
+  // Edges of the removed vertex are moved to the kept vertex unless they
+  // are still referred to by removed faces or the kept vertex has the edge.
+  const auto es = vertex_edges_[b];
+  for (auto&& ej : es) {
+    if (!this->is_valid(ej)) continue;
+    const auto& e = edges_[ej];
+    const auto x = e.first == b ? e.second : e.first;
+    if (x != a && edge_faces_[ej].empty() &&
+        !this->find(edge_type{a, x}).is_valid()) {
+      this->move_edge(ej, a, x);
+      edit.modified_edges.push_back(ej);
+    } else {
+      this->set_valid(ej, false);
+      has_invalid_edges_ = true;
+      edit.removed_edges.push_back(ej);
+    }
+  }
+
+  for (auto&& fi : moved) {
+    for (auto&& vi : faces_[fi])
+      if (vi == b) vi = a;
+    this->find_reused_edges(faces_[fi], edit.modified_edges);
+    this->update_face_connectivity(fi);
+    edit.modified_faces.push_back(fi);
+  }
+
+  // Edges and vertices only shared by removed faces are isolated.
+  for (auto&& ej : vertex_edges_[a]) {
+    if (this->is_valid(ej) && this->is_isolated(ej)) {
+      this->set_valid(ej, false);
+      has_invalid_edges_ = true;
+      edit.removed_edges.push_back(ej);
+    }
+  }
+  this->set_valid(b, false);
+  has_invalid_vertices_ = true;
+  opposite.push_back(a);
+  for (auto&& vi : opposite) {
+    if (this->is_valid(vi) && this->is_isolated(vi)) {
+      this->set_valid(vi, false);
+    }
+  }
+  return edit;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::checkpoint() {
+  checkpoints_.push_back({vertices_.size(), edges_.size(), faces_.size(),
+                          journal_.size(), has_invalid_vertices_,
+                          has_invalid_edges_, has_invalid_faces_});
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::rollback() {
+  assert(!checkpoints_.empty());
+  FMESH_SCOPED_TIMER("fracture_mesh::rollback");
+  const auto mark = checkpoints_.back();
+  checkpoints_.pop_back();
+
+  // Reverts changes of existing entities in the reverse order.
+  using kind = detail::journal_entry::kind;
+  while (journal_.size() > mark.journal_size) {
+    const auto [type, i] = journal_.back();
+    journal_.pop_back();
+    switch (type) {
+      case kind::vertex_edge:
+        vertex_edges_[vertex_index{i}].pop_back();
+        if constexpr (Relations::vertex_vertices)
+          vertex_vertices_[vertex_index{i}].pop_back();
+        break;
+      case kind::vertex_face:
+        vertex_faces_[vertex_index{i}].pop_back();
+        break;
+      case kind::edge_face:
+        edge_faces_[edge_index{i}].pop_back();
+        break;
+      case kind::vertex_validity:
+        is_valid_vertex_[vertex_index{i}] = !is_valid_vertex_[vertex_index{i}];
+        break;
+      case kind::edge_validity:
+        is_valid_edge_[edge_index{i}] = !is_valid_edge_[edge_index{i}];
+        break;
+      case kind::face_validity:
+        is_valid_face_[face_index{i}] = !is_valid_face_[face_index{i}];
+        break;
+    }
+  }
+
+  // Removes new entities.
+  vertices_.resize(mark.num_vertices);
+  if constexpr (Relations::vertex_vertices)
+    vertex_vertices_.resize(mark.num_vertices);
+  vertex_edges_.resize(mark.num_vertices);
+  if constexpr (Relations::vertex_faces)
+    vertex_faces_.resize(mark.num_vertices);
+  is_valid_vertex_.resize(mark.num_vertices);
+  this->clear_caches();
+
+  edges_.resize(mark.num_edges);
+  edge_faces_.resize(mark.num_edges);
+  is_valid_edge_.resize(mark.num_edges);
+
+  faces_.resize(mark.num_faces);
+  face_edges_.resize(mark.num_faces);
+  is_valid_face_.resize(mark.num_faces);
+  face_fractures_.resize(mark.num_faces);
+  for (auto&& offset : fracture_offsets_)
+    offset = std::min(offset, mark.num_faces);
+
+  has_invalid_vertices_ = mark.has_invalid_vertices;
+  has_invalid_edges_ = mark.has_invalid_edges;
+  has_invalid_faces_ = mark.has_invalid_faces;
+  this->log_change(mesh_change::entity::mesh, mesh_change::kind::renumbered,
+                   0);
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::
+    release_checkpoint() {
+  assert(!checkpoints_.empty());
+  checkpoints_.pop_back();
+  if (checkpoints_.empty()) journal_.clear();
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::track_changes(
+    bool enable) {
+  is_tracking_changes_ = enable;
+  if (!enable) {
+    changes_.clear();
+    first_logged_epoch_ = epoch_;
+  }
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+change_set fracture_mesh<Point, Face, PointAllocator, Relations>::changed_since(
+    std::uint64_t epoch) const {
+  change_set changes;
+  for (auto&& c : this->changes_since(epoch)) {
+    switch (c.type) {
+      case mesh_change::entity::vertex:
+        changes.vertices.push_back(vertex_index{c.index});
+        break;
+      case mesh_change::entity::edge:
+        changes.edges.push_back(edge_index{c.index});
+        break;
+      case mesh_change::entity::face:
+        changes.faces.push_back(face_index{c.index});
+        break;
+      case mesh_change::entity::mesh:
+        return {true, {}, {}, {}};
+    }
+  }
+  const auto sort_unique = [](auto& list) {
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+  };
+  sort_unique(changes.vertices);
+  sort_unique(changes.edges);
+  sort_unique(changes.faces);
+  return changes;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::discard_changes(
+    std::uint64_t epoch) {
+  epoch = std::clamp(epoch, first_logged_epoch_, epoch_);
+  changes_.erase(changes_.begin(),
+                 changes_.begin() +
+                     static_cast<std::ptrdiff_t>(epoch - first_logged_epoch_));
+  first_logged_epoch_ = epoch;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::record(
+    detail::journal_entry::kind type, std::size_t i) {
+  if (checkpoints_.empty()) return;
+
+  // Changes of entities created after the last checkpoint need not be
+  // recorded because the entities are removed by rollback().
+  using kind = detail::journal_entry::kind;
+  const auto& mark = checkpoints_.back();
+  switch (type) {
+    case kind::vertex_edge:
+    case kind::vertex_face:
+    case kind::vertex_validity:
+      if (i >= mark.num_vertices) return;
+      break;
+    case kind::edge_face:
+    case kind::edge_validity:
+      if (i >= mark.num_edges) return;
+      break;
+    case kind::face_validity:
+      if (i >= mark.num_faces) return;
+      break;
+  }
+  journal_.push_back({type, i});
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::set_valid(
+    vertex_index vi, bool valid) {
+  if (this->is_valid(vi) == valid) return;
+  this->record(detail::journal_entry::kind::vertex_validity,
+               static_cast<std::size_t>(vi));
+  is_valid_vertex_[vi] = valid;
+  this->log_change(mesh_change::entity::vertex,
+                   valid ? mesh_change::kind::validated
+                         : mesh_change::kind::invalidated,
+                   static_cast<std::size_t>(vi));
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::set_valid(
+    edge_index ei, bool valid) {
+  if (this->is_valid(ei) == valid) return;
+  this->record(detail::journal_entry::kind::edge_validity,
+               static_cast<std::size_t>(ei));
+  is_valid_edge_[ei] = valid;
+  this->log_change(mesh_change::entity::edge,
+                   valid ? mesh_change::kind::validated
+                         : mesh_change::kind::invalidated,
+                   static_cast<std::size_t>(ei));
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::set_valid(
+    face_index fi, bool valid) {
+  if (this->is_valid(fi) == valid) return;
+  this->record(detail::journal_entry::kind::face_validity,
+               static_cast<std::size_t>(fi));
+  is_valid_face_[fi] = valid;
+  this->log_change(mesh_change::entity::face,
+                   valid ? mesh_change::kind::validated
+                         : mesh_change::kind::invalidated,
+                   static_cast<std::size_t>(fi));
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::reserve(
+    std::size_t nv, std::size_t ne, std::size_t nf, std::size_t valence) {
+  valence_ = valence;
+
+  vertices_.reserve(nv);
+  if constexpr (Relations::vertex_vertices) vertex_vertices_.reserve(nv);
+  vertex_edges_.reserve(nv);
+  if constexpr (Relations::vertex_faces) vertex_faces_.reserve(nv);
+  is_valid_vertex_.reserve(nv);
+
+  edges_.reserve(ne);
+  edge_faces_.reserve(ne);
+  is_valid_edge_.reserve(ne);
+
+  faces_.reserve(nf);
+  face_edges_.reserve(nf);
+  is_valid_face_.reserve(nf);
+  face_fractures_.reserve(nf);
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::shrink_to_fit() {
+  const auto shrink_lists = [](auto& lists) {
+    for (auto&& list : lists) list.shrink_to_fit();
+    lists.shrink_to_fit();
+  };
+
+  vertices_.shrink_to_fit();
+  shrink_lists(vertex_vertices_);
+  shrink_lists(vertex_edges_);
+  shrink_lists(vertex_faces_);
+  is_valid_vertex_.shrink_to_fit();
+
+  edges_.shrink_to_fit();
+  shrink_lists(edge_faces_);
+  is_valid_edge_.shrink_to_fit();
+
+  faces_.shrink_to_fit();
+  shrink_lists(face_edges_);
+  is_valid_face_.shrink_to_fit();
+  face_fractures_.shrink_to_fit();
+
+  changes_.shrink_to_fit();
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::
+    build_vertex_vertices() const {
+  vertex_vertices_.resize(vertices_.size());
+  for (vertex_index vi{0}; vi < vertex_index{vertices_.size()}; ++vi) {
+    auto& vs = vertex_vertices_[vi];
+    vs.clear();
+    for (auto&& ei : vertex_edges_[vi]) {
+      const auto& e = edges_[ei];
+      vs.push_back(e.first == vi ? e.second : e.first);
+    }
+  }
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::
+    cache_vertex_vertices() const {
+  if (has_vertex_vertices_cache_) return;
+  FMESH_SCOPED_TIMER("fracture_mesh::cache_vertex_vertices");
+  this->build_vertex_vertices();
+  has_vertex_vertices_cache_ = true;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::
+    cache_vertex_faces() const {
+  if (has_vertex_faces_cache_) return;
+  FMESH_SCOPED_TIMER("fracture_mesh::cache_vertex_faces");
+  for (auto&& fs : vertex_faces_) fs.clear();
+  vertex_faces_.resize(vertices_.size());
+  for (face_index fi{0}; fi < face_index{faces_.size()}; ++fi)
+    for (auto&& vi : faces_[fi]) vertex_faces_[vi].push_back(fi);
+  has_vertex_faces_cache_ = true;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void
+fracture_mesh<Point, Face, PointAllocator, Relations>::add_vertex_connectivity(
+    const vertex_index vi) {
+  const auto n = vertices_.size();
+  vertex_edges_.resize(n);
+  if (valence_ > 0) vertex_edges_[vi].reserve(valence_);
+  if (this->has_vertex_vertices()) {
+    vertex_vertices_.resize(n);
+    if (valence_ > 0) vertex_vertices_[vi].reserve(valence_);
   }
+  if (this->has_vertex_faces()) {
+    vertex_faces_.resize(n);
+    if (valence_ > 0) vertex_faces_[vi].reserve(valence_);
+  }
+  is_valid_vertex_.push_back(true);
+  this->log_change(mesh_change::entity::vertex, mesh_change::kind::created,
+                   static_cast<std::size_t>(vi));
 }
 
-template <typename Point, typename Face, typename PointAllocator>
-void fracture_mesh<Point, Face, PointAllocator>::update_face_connectivity(
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void
+fracture_mesh<Point, Face, PointAllocator, Relations>::update_face_connectivity(
     const face_index fi) noexcept {
   const auto& f = faces_[fi];
-  for (auto&& vi : f) vertex_faces_[vi].push_back(fi);
+  // Vertices invalidated with their last face are used again.
+  for (auto&& vi : f) this->set_valid(vi, true);
+  // Caches are dropped by rollback(), so only maintained relations are
+  // journaled.
+  if (this->has_vertex_faces()) {
+    for (auto&& vi : f) {
+      if constexpr (Relations::vertex_faces) {
+        this->record(detail::journal_entry::kind::vertex_face,
+                     static_cast<std::size_t>(vi));
+      }
+      this->append(vertex_faces_[vi], fi);
+    }
+  }
   const auto fedges = f.to_edges();
+  face_edges_[fi].reserve(fedges.size());
 
   for (auto&& e : fedges) {
     const auto ei = this->find(e);
 
     if (ei.is_valid()) {
       // Edge already resitered
-      // So only edge-face connectivity data are updated
-      face_edges_[fi].push_back(ei);
-      edge_faces_[ei].push_back(fi);
+      // So only edge-face connectivity data are updated.
+      // An invalidated edge is reused by the new face.
+      this->set_valid(ei, true);
+      this->append(face_edges_[fi], ei);
+      this->record(detail::journal_entry::kind::edge_face,
+                   static_cast<std::size_t>(ei));
+      this->append(edge_faces_[ei], fi);
     } else {
       // An edge is new
       // So first regiter the new edge, and then update all connectivity data.
       const edge_index ej{edges_.size()};
-      edges_.push_back(e);
+      FMESH_INSTRUMENT(++counters_.edge_insertions);
+      this->append(edges_, e);
       edge_faces_.resize(edges_.size());
+      // Most edges are shared by two faces.
+      edge_faces_[ej].reserve(2);
       is_valid_edge_.push_back(true);
+      this->log_change(mesh_change::entity::edge, mesh_change::kind::created,
+                       static_cast<std::size_t>(ej));
 
       // Update vertex-edges and vertex-vertices
-      vertex_edges_[e.first].push_back(ej);
-      vertex_edges_[e.second].push_back(ej);
-      vertex_vertices_[e.first].push_back(e.second);
-      vertex_vertices_[e.second].push_back(e.first);
+      this->record(detail::journal_entry::kind::vertex_edge,
+                   static_cast<std::size_t>(e.first));
+      this->record(detail::journal_entry::kind::vertex_edge,
+                   static_cast<std::size_t>(e.second));
+      this->append(vertex_edges_[e.first], ej);
+      this->append(vertex_edges_[e.second], ej);
+      if (this->has_vertex_vertices()) {
+        this->append(vertex_vertices_[e.first], e.second);
+        this->append(vertex_vertices_[e.second], e.first);
+      }
 
       // Update edge-faces and face-edges
-      edge_faces_[ej].push_back(fi);
-      face_edges_[fi].push_back(ej);
+      this->append(edge_faces_[ej], fi);
+      this->append(face_edges_[fi], ej);
     }
   }
 }
 
-template <typename Point, typename Face, typename PointAllocator>
-void fracture_mesh<Point, Face, PointAllocator>::remove_invalid_entities() {
-  if (!this->has_invalid_entities()) return;
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::check_editable(
+    const char* name) const {
+  if (!checkpoints_.empty()) {
+    throw std::logic_error{std::string{"fracture_mesh::"} + name +
+                           ": a checkpoint is active"};
+  }
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+face_index fracture_mesh<Point, Face, PointAllocator, Relations>::append_face(
+    const Face& f, fracture_index k) {
+  const face_index fi{faces_.size()};
+  FMESH_INSTRUMENT(++counters_.face_insertions);
+  this->append(faces_, f);
+  face_edges_.resize(faces_.size());
+  is_valid_face_.push_back(true);
+
+  // The face extends the range of its fracture if later fractures are empty.
+  this->extend_fractures(k);
+  face_fractures_.push_back(k);
+  if (are_fractures_contiguous_ && fracture_offsets_[k.get() + 1] == fi.get()) {
+    for (auto j = k.get() + 1; j < fracture_offsets_.size(); ++j)
+      ++fracture_offsets_[j];
+  } else {
+    are_fractures_contiguous_ = false;
+  }
+  this->update_face_connectivity(fi);
+  this->log_change(mesh_change::entity::face, mesh_change::kind::created,
+                   static_cast<std::size_t>(fi));
+  return fi;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::detach_face(
+    const face_index fi) {
+  const auto erase = [](auto& list, auto i) {
+    list.erase(std::find(list.begin(), list.end(), i));
+  };
+  if (this->has_vertex_faces()) {
+    for (auto&& vi : faces_[fi]) erase(vertex_faces_[vi], fi);
+  }
+  for (auto&& ei : face_edges_[fi]) erase(edge_faces_[ei], fi);
+  face_edges_[fi].clear();
+  this->log_change(mesh_change::entity::face, mesh_change::kind::modified,
+                   static_cast<std::size_t>(fi));
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::move_edge(
+    const edge_index ei, const vertex_index v1, const vertex_index v2) {
+  // Vertex-vertices stay parallel to vertex-edges.
+  for (auto&& vi : {edges_[ei].first, edges_[ei].second}) {
+    auto& es = vertex_edges_[vi];
+    const auto k = std::find(es.begin(), es.end(), ei) - es.begin();
+    es.erase(es.begin() + k);
+    if (this->has_vertex_vertices())
+      vertex_vertices_[vi].erase(vertex_vertices_[vi].begin() + k);
+  }
+  edges_[ei] = edge_type{v1, v2};
+  this->append(vertex_edges_[v1], ei);
+  this->append(vertex_edges_[v2], ei);
+  if (this->has_vertex_vertices()) {
+    this->append(vertex_vertices_[v1], v2);
+    this->append(vertex_vertices_[v2], v1);
+  }
+  this->log_change(mesh_change::entity::edge, mesh_change::kind::modified,
+                   static_cast<std::size_t>(ei));
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::find_reused_edges(
+    const Face& f, std::vector<edge_index>& es) const {
+  for (auto&& e : f.to_edges()) {
+    const auto ei = this->find(e);
+    if (ei.is_valid() && !this->is_valid(ei)) es.push_back(ei);
+  }
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+std::vector<face_index>
+fracture_mesh<Point, Face, PointAllocator, Relations>::valid_faces(
+    const edge_index ei) const {
+  std::vector<face_index> fs;
+  for (auto&& fi : edge_faces_[ei])
+    if (this->is_valid(fi)) fs.push_back(fi);
+  return fs;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+std::vector<face_index>
+fracture_mesh<Point, Face, PointAllocator, Relations>::valid_faces(
+    const vertex_index vi) const {
+  std::vector<face_index> fs;
+  this->for_each_vertex_face(vi, [this, &fs](face_index fi) {
+    if (this->is_valid(fi)) fs.push_back(fi);
+  });
+  std::sort(fs.begin(), fs.end());
+  fs.erase(std::unique(fs.begin(), fs.end()), fs.end());
+  return fs;
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+entity_remap
+fracture_mesh<Point, Face, PointAllocator, Relations>::
+    remove_invalid_entities() {
+  FMESH_SCOPED_TIMER("fracture_mesh::remove_invalid_entities");
+  if (!checkpoints_.empty()) {
+    throw std::logic_error{
+        "fracture_mesh::remove_invalid_entities: a checkpoint is active"};
+  }
+  entity_remap remap;
+  remap.vertices.resize(vertices_.size());
+  remap.edges.resize(edges_.size());
+  remap.faces.resize(faces_.size());
+
+  const auto make_map = [](const auto& is_valid, auto& map) {
+    using index_type = typename std::decay_t<decltype(map)>::value_type;
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < map.size(); ++i) {
+      if (is_valid[index_type{i}]) map[index_type{i}] = index_type{n++};
+    }
+    return n;
+  };
+  const auto nv = make_map(is_valid_vertex_, remap.vertices);
+  const auto ne = make_map(is_valid_edge_, remap.edges);
+  const auto nf = this->make_face_map(remap.faces);
+
+  if (nv == vertices_.size() && ne == edges_.size() && nf == faces_.size() &&
+      are_fractures_contiguous_)
+    return remap;
+
+  // Removes invalid indices from a list and renumbers the others
+  const auto update_list = [](auto& list, const auto& map) {
+    auto last = list.begin();
+    for (auto&& i : list) {
+      const auto j = map[i];
+      if (j.is_valid()) *last++ = j;
+    }
+    list.erase(last, list.end());
+  };
+
+  compact(vertices_, remap.vertices);
+  compact(vertex_edges_, remap.vertices);
+  for (auto&& es : vertex_edges_) update_list(es, remap.edges);
+  if constexpr (Relations::vertex_faces) {
+    compact(vertex_faces_, remap.vertices);
+    for (auto&& fs : vertex_faces_) update_list(fs, remap.faces);
+  } else {
+    vertex_faces_.clear();
+  }
 
-  if (has_invalid_vertices_) {
-    //
+  compact(edges_, remap.edges);
+  compact(edge_faces_, remap.edges);
+  for (auto&& e : edges_) {
+    e.first = remap.vertices[e.first];
+    e.second = remap.vertices[e.second];
   }
+  for (auto&& fs : edge_faces_) update_list(fs, remap.faces);
+
+  // Vertex-vertices must stay parallel to vertex-edges.
+  vertex_vertices_.clear();
+  this->clear_caches();
+  if constexpr (Relations::vertex_vertices) this->build_vertex_vertices();
+
+  compact(faces_, remap.faces);
+  compact(face_edges_, remap.faces);
+  compact(face_fractures_, remap.faces);
+  for (auto&& f : faces_)
+    for (auto&& vi : f) vi = remap.vertices[vi];
+  for (auto&& es : face_edges_) update_list(es, remap.edges);
+
+  is_valid_vertex_.clear();
+  is_valid_vertex_.resize(nv, true);
+  is_valid_edge_.clear();
+  is_valid_edge_.resize(ne, true);
+  is_valid_face_.clear();
+  is_valid_face_.resize(nf, true);
+
+  has_invalid_vertices_ = false;
+  has_invalid_edges_ = false;
+  has_invalid_faces_ = false;
+  are_fractures_contiguous_ = true;
+  this->log_change(mesh_change::entity::mesh, mesh_change::kind::renumbered,
+                   0);
+  return remap;
+}
 
-  if (has_invalid_edges_) {
-    //
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+std::size_t
+fracture_mesh<Point, Face, PointAllocator, Relations>::make_face_map(
+    face_property<face_index>& map) {
+  // Counting sort by fracture, stable within each fracture.
+  std::fill(fracture_offsets_.begin(), fracture_offsets_.end(), 0);
+  for (std::size_t i = 0; i < faces_.size(); ++i) {
+    const face_index fi{i};
+    if (is_valid_face_[fi]) ++fracture_offsets_[face_fractures_[fi].get() + 1];
   }
+  for (std::size_t k = 1; k < fracture_offsets_.size(); ++k)
+    fracture_offsets_[k] += fracture_offsets_[k - 1];
+
+  auto next = fracture_offsets_;
+  for (std::size_t i = 0; i < faces_.size(); ++i) {
+    const face_index fi{i};
+    if (is_valid_face_[fi])
+      map[fi] = face_index{next[face_fractures_[fi].get()]++};
+  }
+  return fracture_offsets_.back();
+}
+
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+void fracture_mesh<Point, Face, PointAllocator, Relations>::set_face_fracture(
+    face_index fi, fracture_index k) {
+  if (face_fractures_[fi] == k) return;
+  this->extend_fractures(k);
+  face_fractures_[fi] = k;
+  are_fractures_contiguous_ = false;
+  this->log_change(mesh_change::entity::face, mesh_change::kind::modified,
+                   fi.get());
+}
 
-  if (has_invalid_faces_) {
-    //
+template <typename Point, typename Face, typename PointAllocator,
+          typename Relations>
+std::vector<fracture_intersection>
+fracture_mesh<Point, Face, PointAllocator, Relations>::fracture_intersections()
+    const {
+  // Collects (fracture pair, edge) for each pair of fractures at an edge.
+  using pair_type = std::pair<std::size_t, std::size_t>;
+  std::vector<std::pair<pair_type, edge_index>> shared;
+  std::vector<std::size_t> ks;
+  for (std::size_t i = 0; i < edges_.size(); ++i) {
+    const edge_index ei{i};
+    if (!is_valid_edge_[ei] || edge_faces_[ei].size() < 2) continue;
+    ks.clear();
+    for (auto&& fi : edge_faces_[ei])
+      if (is_valid_face_[fi]) ks.push_back(face_fractures_[fi].get());
+    std::sort(ks.begin(), ks.end());
+    ks.erase(std::unique(ks.begin(), ks.end()), ks.end());
+    for (std::size_t a = 0; a < ks.size(); ++a)
+      for (std::size_t b = a + 1; b < ks.size(); ++b)
+        shared.push_back({{ks[a], ks[b]}, ei});
+  }
+  std::sort(shared.begin(), shared.end());
+
+  std::vector<fracture_intersection> intersections;
+  for (auto&& [pair, ei] : shared) {
+    if (intersections.empty() ||
+        intersections.back().first.get() != pair.first ||
+        intersections.back().second.get() != pair.second) {
+      intersections.push_back({fracture_index{pair.first},
+                               fracture_index{pair.second}, {}});
+    }
+    intersections.back().edges.push_back(ei);
   }
+  return intersections;
 }
 
 }  // namespace fmesh
@@ -0,0 +1,201 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_GEOMETRY_HPP
+#define FMESH_GEOMETRY_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include "fmesh/index.hpp"
+#include "fmesh/point_traits.hpp"
+
+namespace fmesh {
+
+/// @brief Three-dimensional vector used by geometric algorithms
+struct vector3 {
+  double x = 0.0;
+  double y = 0.0;
+  double z = 0.0;
+
+  vector3() = default;
+  vector3(double tx, double ty, double tz) : x{tx}, y{ty}, z{tz} {}
+
+  vector3& operator+=(const vector3& v) noexcept {
+    x += v.x;
+    y += v.y;
+    z += v.z;
+    return *this;
+  }
+  vector3& operator-=(const vector3& v) noexcept {
+    x -= v.x;
+    y -= v.y;
+    z -= v.z;
+    return *this;
+  }
+  vector3& operator*=(double s) noexcept {
+    x *= s;
+    y *= s;
+    z *= s;
+    return *this;
+  }
+  vector3& operator/=(double s) noexcept {
+    x /= s;
+    y /= s;
+    z /= s;
+    return *this;
+  }
+
+  friend vector3 operator+(vector3 u, const vector3& v) noexcept {
+    return u += v;
+  }
+  friend vector3 operator-(vector3 u, const vector3& v) noexcept {
+    return u -= v;
+  }
+  friend vector3 operator-(const vector3& v) noexcept {
+    return {-v.x, -v.y, -v.z};
+  }
+  friend vector3 operator*(vector3 v, double s) noexcept { return v *= s; }
+  friend vector3 operator*(double s, vector3 v) noexcept { return v *= s; }
+  friend vector3 operator/(vector3 v, double s) noexcept { return v /= s; }
+
+  friend std::ostream& operator<<(std::ostream& os, const vector3& v) {
+    return os << v.x << ' ' << v.y << ' ' << v.z;
+  }
+};
+
+inline double dot(const vector3& u, const vector3& v) noexcept {
+  return u.x * v.x + u.y * v.y + u.z * v.z;
+}
+
+inline vector3 cross(const vector3& u, const vector3& v) noexcept {
+  return {u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z,
+          u.x * v.y - u.y * v.x};
+}
+
+inline double norm(const vector3& v) noexcept { return std::sqrt(dot(v, v)); }
+
+/// @brief Converts a point to vector3
+template <typename Point>
+vector3 to_vector3(const Point& p) noexcept {
+  using traits = point_traits<Point>;
+  return {traits::x(p), traits::y(p), traits::z(p)};
+}
+
+/// @brief Converts vector3 to a point
+template <typename Point>
+Point to_point(const vector3& v) {
+  return point_traits<Point>::make(v.x, v.y, v.z);
+}
+
+/// @brief Returns the length of an edge
+template <typename Mesh>
+double edge_length(const Mesh& mesh, edge_index ei) {
+  const auto& e = mesh.edge(ei);
+  return norm(to_vector3(mesh.vertex(e.second)) -
+              to_vector3(mesh.vertex(e.first)));
+}
+
+/// @brief Returns the centroid of the vertices of a face
+template <typename Mesh>
+vector3 centroid(const Mesh& mesh, const typename Mesh::face_type& f) {
+  vector3 c;
+  for (auto&& vi : f) c += to_vector3(mesh.vertex(vi));
+  return c / static_cast<double>(f.size());
+}
+
+/// @brief Returns the area vector of a face
+///
+/// The area vector is normal to the face and its length is the face area.
+/// Non-planar quadrilaterals are split into triangles fanning from the first
+/// vertex.
+template <typename Mesh>
+vector3 area_vector(const Mesh& mesh, const typename Mesh::face_type& f) {
+  constexpr auto N = Mesh::face_type::num_vertices;
+  const auto p0 = to_vector3(mesh.vertex(f[0]));
+  vector3 a;
+  for (std::size_t i = 1; i + 1 < N; ++i)
+    a += cross(to_vector3(mesh.vertex(f[i])) - p0,
+               to_vector3(mesh.vertex(f[i + 1])) - p0);
+  return 0.5 * a;
+}
+
+namespace detail {
+
+/// @brief Cell of a uniform grid used as a spatial hash
+struct grid_cell {
+  std::int64_t i;
+  std::int64_t j;
+  std::int64_t k;
+
+  friend bool operator==(const grid_cell& a, const grid_cell& b) noexcept {
+    return a.i == b.i && a.j == b.j && a.k == b.k;
+  }
+
+  /// @brief Lexicographic order, in which cells of a row along k are
+  /// contiguous
+  friend bool operator<(const grid_cell& a, const grid_cell& b) noexcept {
+    if (a.i != b.i) return a.i < b.i;
+    if (a.j != b.j) return a.j < b.j;
+    return a.k < b.k;
+  }
+};
+
+/// @brief Hash of grid cells, which multiplies without signed overflow
+struct grid_cell_hash {
+  std::size_t operator()(const grid_cell& c) const noexcept {
+    return static_cast<std::size_t>(
+        (static_cast<std::uint64_t>(c.i) * 73856093u) ^
+        (static_cast<std::uint64_t>(c.j) * 19349663u) ^
+        (static_cast<std::uint64_t>(c.k) * 83492791u));
+  }
+};
+
+/// @brief Returns the cell containing a point
+/// @param[in] p Point
+/// @param[in] h Cell size
+/// @throw std::invalid_argument If a coordinate divided by the cell size is
+/// not finite or its magnitude is not less than 2^53
+///
+/// Beyond 2^53 cells, doubles cannot tell neighbouring cells apart. The
+/// limit also keeps indices of neighbouring cells and differences of cell
+/// indices within std::int64_t.
+inline grid_cell to_grid_cell(const vector3& p, double h) {
+  constexpr auto limit = 9007199254740992.0;  // 2^53
+  const auto to_index = [](double x) {
+    if (!(std::abs(x) < limit)) {
+      throw std::invalid_argument{
+          "fmesh: point is out of range of the grid for its cell size"};
+    }
+    return static_cast<std::int64_t>(std::floor(x));
+  };
+  return {to_index(p.x / h), to_index(p.y / h), to_index(p.z / h)};
+}
+
+}  // namespace detail
+
+}  // namespace fmesh
+
+#endif  // FMESH_GEOMETRY_HPP
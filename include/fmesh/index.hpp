@@ -26,6 +26,7 @@
 #include <cstddef>
 #include <iostream>
 #include <limits>
+#include <type_traits>
 
 namespace fmesh {
 
@@ -94,10 +95,19 @@ class index {
 struct vertex_tag {};
 struct edge_tag {};
 struct face_tag {};
+struct fracture_tag {};
 
 using vertex_index = index<vertex_tag>;
 using edge_index = index<edge_tag>;
 using face_index = index<face_tag>;
+using fracture_index = index<fracture_tag>;
+
+// Arrays of indices can be passed to external libraries as arrays of
+// std::size_t.
+static_assert(sizeof(vertex_index) == sizeof(std::size_t) &&
+                  std::is_standard_layout_v<vertex_index> &&
+                  std::is_trivially_copyable_v<vertex_index>,
+              "Indices must have the layout of std::size_t.");
 
 }  // namespace fmesh
 
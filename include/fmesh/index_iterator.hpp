@@ -72,10 +72,20 @@ class index_iterator {
     return *this;
   }
   index_iterator operator+(difference_type n) const noexcept {
-    return index_iterator{idx_ + n};
+    index_iterator tmp{*this};
+    tmp.idx_ += n;
+    return tmp;
   }
   index_iterator operator-(difference_type n) const noexcept {
-    return index_iterator{idx_ - n};
+    index_iterator tmp{*this};
+    tmp.idx_ -= n;
+    return tmp;
+  }
+
+  friend difference_type operator-(const index_iterator& it1,
+                                   const index_iterator& it2) noexcept {
+    return static_cast<difference_type>(it1.idx_.get()) -
+           static_cast<difference_type>(it2.idx_.get());
   }
 
   friend bool operator==(const index_iterator& it1,
@@ -0,0 +1,285 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_INSTRUMENTATION_HPP
+#define FMESH_INSTRUMENTATION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// @file
+/// Instrumentation of mesh operations
+///
+/// Counters and scoped timers are compiled in only if FMESH_ENABLE_INSTRUMENTATION
+/// is defined, and cost nothing otherwise. The macro must be defined
+/// consistently in all translation units of a program, e.g. by the CMake
+/// option of the same name. Memory usage reports are always available.
+
+#ifdef FMESH_ENABLE_INSTRUMENTATION
+#define FMESH_INSTRUMENT(statement) statement
+#define FMESH_SCOPED_TIMER_CAT2(a, b) a##b
+#define FMESH_SCOPED_TIMER_CAT(a, b) FMESH_SCOPED_TIMER_CAT2(a, b)
+#define FMESH_SCOPED_TIMER(name) \
+  ::fmesh::scoped_timer FMESH_SCOPED_TIMER_CAT(fmesh_timer_, __LINE__) { name }
+#else
+#define FMESH_INSTRUMENT(statement)
+#define FMESH_SCOPED_TIMER(name)
+#endif
+
+namespace fmesh {
+
+/// @brief Is instrumentation compiled in?
+#ifdef FMESH_ENABLE_INSTRUMENTATION
+constexpr bool instrumentation_enabled = true;
+#else
+constexpr bool instrumentation_enabled = false;
+#endif
+
+/// @brief Counters of hot-path operations of a mesh
+struct mesh_counters {
+  /// Calls of find(edge_type) and edges compared by them
+  std::uint64_t edge_lookups = 0;
+  std::uint64_t edge_probes = 0;
+  /// Calls of find(Face) and faces compared by them
+  std::uint64_t face_lookups = 0;
+  std::uint64_t face_probes = 0;
+  /// Inserted mesh entities
+  std::uint64_t vertex_insertions = 0;
+  std::uint64_t edge_insertions = 0;
+  std::uint64_t face_insertions = 0;
+  /// Calls of invalidate()
+  std::uint64_t invalidations = 0;
+  /// Reallocations of arrays caused by insertions
+  std::uint64_t reallocations = 0;
+
+  void reset() noexcept { *this = mesh_counters{}; }
+};
+
+namespace detail {
+
+/// @brief Counter which const queries may increment from several threads
+///
+/// Increments are relaxed, since counts are read only after the threads
+/// have been joined. Copies take a snapshot of the value.
+class relaxed_counter {
+ public:
+  relaxed_counter() = default;
+  relaxed_counter(const relaxed_counter& c) noexcept : value_{c.load()} {}
+  relaxed_counter& operator=(const relaxed_counter& c) noexcept {
+    value_.store(c.load(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  relaxed_counter& operator++() noexcept {
+    value_.fetch_add(1, std::memory_order_relaxed);
+    return *this;
+  }
+  relaxed_counter& operator+=(std::uint64_t n) noexcept {
+    value_.fetch_add(n, std::memory_order_relaxed);
+    return *this;
+  }
+  std::uint64_t load() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::uint64_t> value_{0};
+};
+
+/// @brief Counters of a mesh updated by concurrent queries
+struct atomic_mesh_counters {
+  relaxed_counter edge_lookups;
+  relaxed_counter edge_probes;
+  relaxed_counter face_lookups;
+  relaxed_counter face_probes;
+  relaxed_counter vertex_insertions;
+  relaxed_counter edge_insertions;
+  relaxed_counter face_insertions;
+  relaxed_counter invalidations;
+  relaxed_counter reallocations;
+
+  mesh_counters load() const noexcept {
+    return {edge_lookups.load(),      edge_probes.load(),
+            face_lookups.load(),      face_probes.load(),
+            vertex_insertions.load(), edge_insertions.load(),
+            face_insertions.load(),   invalidations.load(),
+            reallocations.load()};
+  }
+  void reset() noexcept { *this = atomic_mesh_counters{}; }
+};
+
+}  // namespace detail
+
+/// @brief Memory used by an array of a mesh
+struct memory_record {
+  std::string name;
+  /// Bytes used by elements
+  std::size_t size_bytes = 0;
+  /// Bytes allocated
+  std::size_t capacity_bytes = 0;
+  /// The number of heap blocks
+  std::size_t heap_blocks = 0;
+};
+
+namespace detail {
+
+template <typename Vector>
+void add_memory(memory_record& r, const Vector& v) {
+  using value_type = typename Vector::value_type;
+  if constexpr (std::is_same_v<value_type, bool>) {
+    r.size_bytes += (v.size() + 7) / 8;
+    r.capacity_bytes += (v.capacity() + 7) / 8;
+  } else {
+    r.size_bytes += v.size() * sizeof(value_type);
+    r.capacity_bytes += v.capacity() * sizeof(value_type);
+  }
+  if (v.capacity() > 0) ++r.heap_blocks;
+}
+
+}  // namespace detail
+
+/// @brief Measures memory of an array of values
+template <typename Array>
+memory_record measure_memory(const std::string& name, const Array& a) {
+  memory_record r{name};
+  detail::add_memory(r, a);
+  return r;
+}
+
+/// @brief Measures memory of an array of lists, including the lists
+template <typename Array>
+memory_record measure_nested_memory(const std::string& name, const Array& a) {
+  memory_record r{name};
+  detail::add_memory(r, a);
+  for (auto&& list : a) detail::add_memory(r, list);
+  return r;
+}
+
+/// @brief Accumulated time of a scoped timer
+struct timer_record {
+  std::uint64_t count = 0;
+  double seconds = 0.0;
+};
+
+/// @brief Process-wide registry of scoped timers
+class timer_registry {
+ public:
+  static timer_registry& instance() {
+    static timer_registry registry;
+    return registry;
+  }
+
+  void add(const std::string& name, double seconds) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto& r = records_[name];
+    ++r.count;
+    r.seconds += seconds;
+  }
+
+  std::map<std::string, timer_record> records() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return records_;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    records_.clear();
+  }
+
+ private:
+  timer_registry() = default;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, timer_record> records_;
+};
+
+/// @brief Adds the lifetime of this object to the timer registry
+class scoped_timer {
+ public:
+  explicit scoped_timer(const char* name)
+      : name_{name}, start_{std::chrono::steady_clock::now()} {}
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+
+  ~scoped_timer() {
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_;
+    timer_registry::instance().add(name_, elapsed.count());
+  }
+
+ private:
+  const char* name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// @name JSON export
+/// @{
+
+inline void write_json(std::ostream& os, const mesh_counters& c) {
+  os << "{\"edge_lookups\":" << c.edge_lookups
+     << ",\"edge_probes\":" << c.edge_probes
+     << ",\"face_lookups\":" << c.face_lookups
+     << ",\"face_probes\":" << c.face_probes
+     << ",\"vertex_insertions\":" << c.vertex_insertions
+     << ",\"edge_insertions\":" << c.edge_insertions
+     << ",\"face_insertions\":" << c.face_insertions
+     << ",\"invalidations\":" << c.invalidations
+     << ",\"reallocations\":" << c.reallocations << '}';
+}
+
+inline void write_json(std::ostream& os,
+                       const std::vector<memory_record>& records) {
+  os << '[';
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    const auto& r = records[i];
+    if (i > 0) os << ',';
+    os << "{\"name\":\"" << r.name << "\",\"size_bytes\":" << r.size_bytes
+       << ",\"capacity_bytes\":" << r.capacity_bytes
+       << ",\"heap_blocks\":" << r.heap_blocks << '}';
+  }
+  os << ']';
+}
+
+inline void write_json(std::ostream& os,
+                       const std::map<std::string, timer_record>& records) {
+  os << '{';
+  bool first = true;
+  for (auto&& [name, r] : records) {
+    if (!first) os << ',';
+    first = false;
+    os << '"' << name << "\":{\"count\":" << r.count
+       << ",\"seconds\":" << r.seconds << '}';
+  }
+  os << '}';
+}
+/// @}
+
+}  // namespace fmesh
+
+#endif  // FMESH_INSTRUMENTATION_HPP
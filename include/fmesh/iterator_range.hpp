@@ -24,6 +24,8 @@
 #define FMESH_ITERATOR_RANGE_HPP
 
 #include <cassert>
+#include <iterator>
+#include <type_traits>
 
 #include "fmesh/index_iterator.hpp"
 
@@ -39,7 +41,10 @@ class iterator_range {
   auto begin() const noexcept { return begin_; }
   auto end() const noexcept { return end_; }
   auto size() const noexcept {
-    assert(begin_ <= end_);
+    if constexpr (std::is_base_of_v<
+                      std::random_access_iterator_tag,
+                      typename std::iterator_traits<Iterator>::iterator_category>)
+      assert(begin_ <= end_);
     return static_cast<std::size_t>(std::distance(begin_, end_));
   }
   bool empty() const noexcept { return begin_ == end_; }
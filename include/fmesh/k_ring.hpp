@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_K_RING_HPP
+#define FMESH_K_RING_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "fmesh/circulator.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/iterator_range.hpp"
+
+namespace fmesh {
+
+/// @brief Reusable result and scratch buffer of k-ring queries
+///
+/// Visited entities are marked by stamping them with the generation of the
+/// current query, so starting a query does not clear the marks. Buffers only
+/// grow, and no memory is allocated once they are large enough.
+template <typename Index>
+class ring_buffer {
+ public:
+  /// @brief Starts a new query over n mesh entities
+  void clear(std::size_t n) {
+    if (stamps_.size() < n) stamps_.resize(n, 0);
+    if (++generation_ == 0) {
+      std::fill(stamps_.begin(), stamps_.end(), 0);
+      generation_ = 1;
+    }
+    indices_.clear();
+    offsets_.clear();
+    offsets_.push_back(0);
+  }
+
+  /// @brief Adds an entity to the current ring if it has not been visited
+  /// @return Is the entity added?
+  bool insert(Index i) {
+    auto& stamp = stamps_[i.get()];
+    if (stamp == generation_) return false;
+    stamp = generation_;
+    indices_.push_back(i);
+    return true;
+  }
+
+  /// @brief Closes the current ring
+  void close_ring() { offsets_.push_back(indices_.size()); }
+
+  /// @brief Returns the number of closed rings
+  std::size_t num_rings() const noexcept { return offsets_.size() - 1; }
+
+  /// @brief Returns the r-th ring
+  ///
+  /// The 0-th ring consists of the center.
+  auto ring(std::size_t r) const noexcept {
+    const auto first = indices_.data();
+    return make_iterator_range(first + offsets_[r], first + offsets_[r + 1]);
+  }
+
+  /// @brief Returns all entities in the order of rings
+  const std::vector<Index>& indices() const noexcept { return indices_; }
+
+  std::size_t size() const noexcept { return indices_.size(); }
+  auto begin() const noexcept { return indices_.begin(); }
+  auto end() const noexcept { return indices_.end(); }
+
+ private:
+  std::vector<Index> indices_;
+  std::vector<std::size_t> offsets_ = {0};
+  std::vector<std::uint32_t> stamps_;
+  std::uint32_t generation_ = 0;
+};
+
+using vertex_ring = ring_buffer<vertex_index>;
+using face_ring = ring_buffer<face_index>;
+
+/// @brief Finds vertices within k valid edges of a vertex
+/// @param[in] mesh Mesh
+/// @param[in] vi Center vertex
+/// @param[in] k The number of rings
+/// @param[out] ring Result, which is reused across queries
+template <typename Mesh>
+void k_ring(const Mesh& mesh, vertex_index vi, std::size_t k,
+            vertex_ring& ring) {
+  ring.clear(mesh.num_vertices());
+  ring.insert(vi);
+  ring.close_ring();
+  for (std::size_t r = 1; r <= k; ++r) {
+    const auto first = ring.indices().size() - ring.ring(r - 1).size();
+    const auto last = ring.indices().size();
+    for (auto i = first; i < last; ++i)
+      for (auto&& vj : adjacent_vertices(mesh, ring.indices()[i]))
+        ring.insert(vj);
+    ring.close_ring();
+  }
+}
+
+/// @brief Finds faces within k steps through valid edges from a face
+/// @param[in] mesh Mesh
+/// @param[in] fi Center face
+/// @param[in] k The number of rings
+/// @param[out] ring Result, which is reused across queries
+///
+/// All faces at a branching edge are neighbors of each other.
+template <typename Mesh>
+void k_ring(const Mesh& mesh, face_index fi, std::size_t k, face_ring& ring) {
+  ring.clear(mesh.num_faces());
+  ring.insert(fi);
+  ring.close_ring();
+  for (std::size_t r = 1; r <= k; ++r) {
+    const auto first = ring.indices().size() - ring.ring(r - 1).size();
+    const auto last = ring.indices().size();
+    for (auto i = first; i < last; ++i)
+      for (auto&& fj : adjacent_faces(mesh, ring.indices()[i]))
+        ring.insert(fj);
+    ring.close_ring();
+  }
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_K_RING_HPP
@@ -0,0 +1,498 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_PARALLEL_HPP
+#define FMESH_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(FMESH_USE_STD_EXECUTION) && __has_include(<execution>)
+#include <execution>
+#define FMESH_HAS_STD_EXECUTION
+#endif
+
+namespace fmesh {
+
+/// @brief Pool of worker threads with work stealing
+///
+/// Each worker has its own deque of tasks. Tasks submitted by a worker are
+/// pushed to the back of its deque and popped from the back, so recursively
+/// split work stays local. Idle workers steal from the front of other deques,
+/// where the largest pieces of work are. Tasks submitted from other threads
+/// are distributed over the deques in turn.
+class thread_pool {
+ public:
+  using task_type = std::function<void()>;
+
+  /// @brief Starts worker threads
+  /// @param[in] num_threads The number of worker threads. If zero, tasks are
+  /// run by threads waiting for them.
+  explicit thread_pool(
+      std::size_t num_threads = std::thread::hardware_concurrency())
+      : queues_(std::max<std::size_t>(num_threads, 1)) {
+    for (auto&& q : queues_) q = std::make_unique<task_queue>();
+    threads_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i)
+      threads_.emplace_back([this, i] { this->work(i); });
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /// @brief Finishes pending tasks and joins worker threads
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto&& t : threads_) t.join();
+  }
+
+  /// @brief Returns the number of worker threads
+  std::size_t num_threads() const noexcept { return threads_.size(); }
+
+  /// @brief Adds a task
+  void submit(task_type task) {
+    const auto i = this->is_worker()
+                       ? worker_id()
+                       : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                             queues_.size();
+    {
+      auto& q = *queues_[i];
+      std::lock_guard<std::mutex> lock{q.mutex};
+      q.tasks.push_back(std::move(task));
+    }
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      ++num_tasks_;
+    }
+    cv_.notify_one();
+  }
+
+  /// @brief Runs a pending task if any
+  /// @return Has a task been run?
+  ///
+  /// Threads waiting for tasks they submitted call this function to help
+  /// instead of blocking.
+  bool run_pending_task() {
+    const auto start = this->is_worker() ? worker_id() : 0;
+    task_type task;
+    // Pops from the back of its own deque, and steals from the front of
+    // others.
+    for (std::size_t k = 0; k < queues_.size(); ++k) {
+      auto& q = *queues_[(start + k) % queues_.size()];
+      std::lock_guard<std::mutex> lock{q.mutex};
+      if (q.tasks.empty()) continue;
+      if (k == 0 && this->is_worker()) {
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+      } else {
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+      }
+      break;
+    }
+    if (!task) return false;
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      --num_tasks_;
+    }
+    task();
+    return true;
+  }
+
+ private:
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<task_type> tasks;
+  };
+
+  static const thread_pool*& current_pool() noexcept {
+    static thread_local const thread_pool* pool = nullptr;
+    return pool;
+  }
+  static std::size_t& worker_id() noexcept {
+    static thread_local std::size_t id = 0;
+    return id;
+  }
+  bool is_worker() const noexcept { return current_pool() == this; }
+
+  void work(std::size_t i) {
+    current_pool() = this;
+    worker_id() = i;
+    while (true) {
+      if (this->run_pending_task()) continue;
+      std::unique_lock<std::mutex> lock{mutex_};
+      cv_.wait(lock, [this] { return stop_ || num_tasks_ > 0; });
+      if (stop_ && num_tasks_ == 0) return;
+    }
+  }
+
+  std::vector<std::unique_ptr<task_queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_queue_{0};
+
+  /// Guards num_tasks_ and stop_ for sleeping workers
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::size_t num_tasks_ = 0;
+  bool stop_ = false;
+};
+
+/// @brief Returns the pool used by default
+///
+/// It has as many workers as hardware threads and lives until the program
+/// exits.
+inline thread_pool& default_thread_pool() {
+  static thread_pool pool;
+  return pool;
+}
+
+namespace detail {
+
+/// @brief Tasks waited for together
+///
+/// The destructor waits for pending tasks, so that tasks never outlive the
+/// group and the data they refer to, even if the waiting thread throws.
+class task_group {
+ public:
+  explicit task_group(thread_pool& pool) : pool_{pool} {}
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  ~task_group() { this->join(); }
+
+  /// @brief Submits a task to the pool
+  template <typename Task>
+  void run(Task&& task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    pool_.submit([this, task = std::forward<Task>(task)] {
+      this->run_here(task);
+      pending_.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  /// @brief Runs a task on the calling thread
+  ///
+  /// Exceptions are kept like those of submitted tasks and rethrown by wait().
+  template <typename Task>
+  void run_here(Task&& task) noexcept {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (!exception_) exception_ = std::current_exception();
+    }
+  }
+
+  /// @brief Waits for all tasks by running pending tasks
+  /// @throw The first exception thrown by a task
+  void wait() {
+    this->join();
+    if (exception_) std::rethrow_exception(exception_);
+  }
+
+ private:
+  void join() noexcept {
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      if (!pool_.run_pending_task()) std::this_thread::yield();
+    }
+  }
+
+  thread_pool& pool_;
+  std::atomic<std::size_t> pending_{0};
+  std::mutex mutex_;
+  std::exception_ptr exception_;
+};
+
+/// @brief Runs f(first[k]) for k in [begin, end), submitting halves of large
+/// ranges as tasks
+template <typename Iterator, typename Function>
+void split_for(task_group& group, Iterator first, std::size_t begin,
+               std::size_t end, std::size_t grain, Function& f) {
+  while (end - begin > grain) {
+    const auto middle = begin + (end - begin) / 2;
+    group.run([&group, first, middle, end, grain, &f] {
+      split_for(group, first, middle, end, grain, f);
+    });
+    end = middle;
+  }
+  for (auto k = begin; k < end; ++k)
+    f(*(first + static_cast<std::ptrdiff_t>(k)));
+}
+
+}  // namespace detail
+
+/// @brief Calls a function for each element of a random-access range in
+/// parallel
+/// @param[in] pool Thread pool
+/// @param[in] range Range, e.g. mesh.faces()
+/// @param[in] f Function called as `f(i)` for each element i. Calls for
+/// different elements must not conflict.
+/// @param[in] grain The largest number of elements processed by a task. If
+/// zero, it is chosen from the number of threads.
+/// @throw The first exception thrown by f
+///
+/// Ranges are split recursively into halves which idle threads can steal, so
+/// uneven work, e.g. skipped invalid entities, is balanced. The calling thread
+/// takes part in the work.
+///
+/// If FMESH_USE_STD_EXECUTION is defined and <execution> is available,
+/// std::for_each with std::execution::par is used instead of the pool. Then
+/// exceptions thrown by f call std::terminate(), and libstdc++ requires
+/// linking TBB.
+template <typename Range, typename Function>
+void parallel_for(thread_pool& pool, Range&& range, Function&& f,
+                  std::size_t grain = 0) {
+  const auto first = std::begin(range);
+  const auto n = static_cast<std::size_t>(std::end(range) - first);
+  if (n == 0) return;
+#ifdef FMESH_HAS_STD_EXECUTION
+  static_cast<void>(pool);
+  static_cast<void>(grain);
+  std::for_each(std::execution::par, first, std::end(range), f);
+#else
+  if (grain == 0) {
+    grain = std::max<std::size_t>(1, n / (8 * (pool.num_threads() + 1)));
+  }
+  detail::task_group group{pool};
+  group.run_here([&] { detail::split_for(group, first, 0, n, grain, f); });
+  group.wait();
+#endif
+}
+
+template <typename Range, typename Function>
+void parallel_for(Range&& range, Function&& f, std::size_t grain = 0) {
+  parallel_for(default_thread_pool(), std::forward<Range>(range),
+               std::forward<Function>(f), grain);
+}
+
+/// @brief Calls a function for each valid entity of a range in parallel
+/// @param[in] mesh Mesh
+/// @param[in] range Range of indices of the mesh, e.g. mesh.faces()
+/// @param[in] f Function called as `f(i)` for each valid entity i
+template <typename Mesh, typename Range, typename Function>
+void parallel_for_valid(const Mesh& mesh, const Range& range, Function&& f,
+                        std::size_t grain = 0) {
+  parallel_for(
+      range,
+      [&mesh, &f](auto i) {
+        if (mesh.is_valid(i)) f(i);
+      },
+      grain);
+}
+
+/// @brief Maps elements of a range and combines the results in parallel
+/// @param[in] range Random-access range
+/// @param[in] init Initial value
+/// @param[in] map Function called as `map(i)` for each element i
+/// @param[in] combine Associative function combining two values
+/// @param[in] grain The number of elements mapped and combined by a task
+/// @return combine(init, combine(...)) of all mapped values
+///
+/// The range is divided into chunks of the grain size, and the partial result
+/// of each chunk is combined in order. Results are therefore reproducible for
+/// a given grain size regardless of the number of threads, even for floating
+/// point sums.
+template <typename Range, typename T, typename Map, typename Combine>
+T parallel_reduce(const Range& range, T init, Map&& map, Combine&& combine,
+                  std::size_t grain = 1024) {
+  const auto first = std::begin(range);
+  const auto n = static_cast<std::size_t>(std::end(range) - first);
+  grain = std::max<std::size_t>(grain, 1);
+  const auto num_chunks = (n + grain - 1) / grain;
+
+  std::vector<T> partials(num_chunks, init);
+  std::vector<std::size_t> chunks(num_chunks);
+  for (std::size_t c = 0; c < num_chunks; ++c) chunks[c] = c;
+  parallel_for(
+      chunks,
+      [&](std::size_t c) {
+        const auto begin = c * grain;
+        const auto end = std::min(n, begin + grain);
+        auto it = first + static_cast<std::ptrdiff_t>(begin);
+        T value = map(*it);
+        for (auto k = begin + 1; k < end; ++k)
+          value = combine(value, map(*++it));
+        partials[c] = std::move(value);
+      },
+      1);
+
+  for (auto&& p : partials) init = combine(init, p);
+  return init;
+}
+
+namespace detail {
+
+/// @brief Calls f(begin, end) for chunks of [0, n) of a grain size in parallel
+template <typename Function>
+void for_each_chunk(std::size_t n, std::size_t grain, Function&& f) {
+  grain = std::max<std::size_t>(grain, 1);
+  std::vector<std::size_t> chunks((n + grain - 1) / grain);
+  std::iota(chunks.begin(), chunks.end(), std::size_t{0});
+  parallel_for(
+      chunks,
+      [n, grain, &f](std::size_t c) {
+        f(c * grain, std::min(n, (c + 1) * grain));
+      },
+      1);
+}
+
+/// @brief Counts nonzero flags in parallel
+/// @param[in] flags Flags
+/// @return Array r of size n + 1, where r[i] is the number of nonzero flags
+/// before i
+///
+/// Marked items are numbered in order by r, like std::exclusive_scan().
+template <typename T>
+std::vector<std::size_t> count_flags(const std::vector<T>& flags,
+                                     std::size_t grain = 1 << 16) {
+  const auto n = flags.size();
+  std::vector<std::size_t> counts(n + 1, 0);
+  std::vector<std::size_t> partials((n + grain - 1) / grain + 1, 0);
+  for_each_chunk(n, grain, [&](std::size_t begin, std::size_t end) {
+    partials[begin / grain + 1] = static_cast<std::size_t>(
+        std::count_if(flags.begin() + static_cast<std::ptrdiff_t>(begin),
+                      flags.begin() + static_cast<std::ptrdiff_t>(end),
+                      [](const T& flag) { return flag != T{}; }));
+  });
+  std::partial_sum(partials.begin(), partials.end(), partials.begin());
+  for_each_chunk(n, grain, [&](std::size_t begin, std::size_t end) {
+    auto count = partials[begin / grain];
+    for (auto i = begin; i < end; ++i) {
+      counts[i] = count;
+      if (flags[i] != T{}) ++count;
+    }
+  });
+  counts[n] = partials.back();
+  return counts;
+}
+
+/// @brief Values grouped by keys in compressed sparse row format
+template <typename T>
+struct grouped_values {
+  /// Values of group k are in [offsets[k], offsets[k + 1])
+  std::vector<std::size_t> offsets;
+  std::vector<T> values;
+};
+
+/// @brief Groups values by keys in parallel
+/// @param[in] num_groups The number of groups
+/// @param[in] num_items The number of items
+/// @param[in] emit Function called as `emit(i, add)` for each item i twice,
+/// which calls `add(k, value)` for each value of the item in group k
+/// @return Values of each group in ascending order
+///
+/// Values are counted and then scattered with atomic counters, and sorting
+/// each group makes the result independent of the number of threads.
+template <typename T, typename Emit>
+grouped_values<T> group_values(std::size_t num_groups, std::size_t num_items,
+                               Emit&& emit, std::size_t grain = 4096) {
+  std::vector<std::atomic<std::size_t>> counters(num_groups);
+  const auto for_each_value = [&](auto&& add) {
+    for_each_chunk(num_items, grain, [&](std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; ++i) emit(i, add);
+    });
+  };
+  for_each_value([&counters](std::size_t k, const T&) {
+    counters[k].fetch_add(1, std::memory_order_relaxed);
+  });
+
+  grouped_values<T> groups;
+  auto& offsets = groups.offsets;
+  offsets.assign(num_groups + 1, 0);
+  for (std::size_t k = 0; k < num_groups; ++k) {
+    offsets[k + 1] = offsets[k] + counters[k].load(std::memory_order_relaxed);
+    counters[k].store(offsets[k], std::memory_order_relaxed);
+  }
+
+  auto& values = groups.values;
+  values.resize(offsets.back());
+  for_each_value([&counters, &values](std::size_t k, const T& value) {
+    values[counters[k].fetch_add(1, std::memory_order_relaxed)] = value;
+  });
+  for_each_chunk(num_groups, grain, [&](std::size_t begin, std::size_t end) {
+    for (auto k = begin; k < end; ++k) {
+      std::sort(values.begin() + static_cast<std::ptrdiff_t>(offsets[k]),
+                values.begin() + static_cast<std::ptrdiff_t>(offsets[k + 1]));
+    }
+  });
+  return groups;
+}
+
+/// @brief Finds the first item with the same key as each item in parallel
+/// @param[in] n The number of items
+/// @param[in] key Function returning the key of an item
+/// @param[in] hash Function hashing a key
+/// @return Index of the first item with the same key for each item
+///
+/// Items are grouped by hashes of their keys, and then sorted within each
+/// group.
+template <typename KeyFunction, typename Hash>
+std::vector<std::size_t> first_occurrences(std::size_t n, KeyFunction&& key,
+                                           Hash&& hash) {
+  using key_type = std::decay_t<decltype(key(std::size_t{0}))>;
+  using value_type = std::pair<key_type, std::size_t>;
+  const auto num_groups = std::max<std::size_t>(1, n / 4);
+  const auto groups = group_values<value_type>(
+      num_groups, n, [&](std::size_t i, auto&& add) {
+        auto k = key(i);
+        const auto g = static_cast<std::size_t>(hash(k) % num_groups);
+        add(g, value_type{std::move(k), i});
+      });
+
+  std::vector<std::size_t> firsts(n);
+  const auto& values = groups.values;
+  for_each_chunk(num_groups, 4096, [&](std::size_t begin, std::size_t end) {
+    for (auto g = begin; g < end; ++g) {
+      std::size_t first = 0;
+      for (auto j = groups.offsets[g]; j < groups.offsets[g + 1]; ++j) {
+        if (j == groups.offsets[g] || !(values[j - 1].first == values[j].first))
+          first = values[j].second;
+        firsts[values[j].second] = first;
+      }
+    }
+  });
+  return firsts;
+}
+
+}  // namespace detail
+
+}  // namespace fmesh
+
+#endif  // FMESH_PARALLEL_HPP
@@ -0,0 +1,379 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_PARTITION_HPP
+#define FMESH_PARTITION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Part id of faces which do not belong to any part
+constexpr auto invalid_part = std::numeric_limits<std::uint32_t>::max();
+
+/// @brief Entries exchanged with a neighboring part
+///
+/// Send and receive lists contain local indices. Both are sorted by global
+/// index, so the i-th entry sent by one part is the i-th entry received by the
+/// other.
+struct halo_exchange {
+  /// Neighboring part
+  std::uint32_t neighbor;
+  /// Owned faces which are ghosts in the neighbor
+  std::vector<face_index> send_faces;
+  /// Ghost faces owned by the neighbor
+  std::vector<face_index> recv_faces;
+  /// Owned vertices which are ghosts in the neighbor
+  std::vector<vertex_index> send_vertices;
+  /// Ghost vertices owned by the neighbor
+  std::vector<vertex_index> recv_vertices;
+  /// Owned edges which are ghosts in the neighbor
+  std::vector<edge_index> send_edges;
+  /// Ghost edges owned by the neighbor
+  std::vector<edge_index> recv_edges;
+};
+
+/// @brief A part of a decomposed mesh
+///
+/// Owned faces come first, followed by ghost faces. A vertex or an edge is
+/// owned by the part with the smallest id among the parts owning its faces.
+template <typename Mesh>
+struct submesh {
+  /// Part id
+  std::uint32_t part;
+  /// Local mesh of owned and ghost faces
+  Mesh mesh;
+  /// The number of owned faces
+  std::size_t num_owned_faces = 0;
+
+  /// @name Maps from local to global indices
+  /// @{
+  vertex_property<vertex_index> global_vertices;
+  edge_property<edge_index> global_edges;
+  face_property<face_index> global_faces;
+  /// @}
+
+  /// @name Owners of local mesh entities
+  /// @{
+  vertex_property<std::uint32_t> vertex_owners;
+  edge_property<std::uint32_t> edge_owners;
+  face_property<std::uint32_t> face_owners;
+  /// @}
+
+  /// Exchange plans sorted by neighbor
+  std::vector<halo_exchange> halo;
+
+  bool is_owned(vertex_index vi) const noexcept {
+    return vertex_owners[vi] == part;
+  }
+  bool is_owned(edge_index ei) const noexcept {
+    return edge_owners[ei] == part;
+  }
+  bool is_owned(face_index fi) const noexcept {
+    return fi.get() < num_owned_faces;
+  }
+
+  /// @brief Returns the local index of a global vertex
+  /// @return Local index, or an invalid index if the vertex is not in the part
+  vertex_index to_local(vertex_index gi) const noexcept {
+    // Vertices are sorted by global index.
+    const auto first = global_vertices.begin();
+    const auto last = global_vertices.end();
+    const auto it = std::lower_bound(first, last, gi);
+    if (it == last || *it != gi) return vertex_index{};
+    return vertex_index{static_cast<std::size_t>(it - first)};
+  }
+
+  /// @brief Returns the local index of a global face
+  /// @return Local index, or an invalid index if the face is not in the part
+  face_index to_local(face_index gi) const noexcept {
+    // Owned and ghost faces are sorted by global index respectively.
+    const auto first = global_faces.begin();
+    const auto mid = first + num_owned_faces;
+    const auto last = global_faces.end();
+    auto it = std::lower_bound(first, mid, gi);
+    if (it == mid || *it != gi) it = std::lower_bound(mid, last, gi);
+    if (it == last || *it != gi) return face_index{};
+    return face_index{static_cast<std::size_t>(it - first)};
+  }
+};
+
+namespace detail {
+
+template <typename Iterator>
+void bisect(const std::vector<vector3>& centroids, Iterator first,
+            Iterator last, std::uint32_t part, std::uint32_t num_parts,
+            face_property<std::uint32_t>& parts) {
+  if (num_parts == 1) {
+    for (auto it = first; it != last; ++it) parts[*it] = part;
+    return;
+  }
+
+  // Cut across the longest side of the bounding box of centroids
+  vector3 lo{std::numeric_limits<double>::max(),
+             std::numeric_limits<double>::max(),
+             std::numeric_limits<double>::max()};
+  vector3 hi = -lo;
+  for (auto it = first; it != last; ++it) {
+    const auto& c = centroids[it->get()];
+    lo = {std::min(lo.x, c.x), std::min(lo.y, c.y), std::min(lo.z, c.z)};
+    hi = {std::max(hi.x, c.x), std::max(hi.y, c.y), std::max(hi.z, c.z)};
+  }
+  const auto d = hi - lo;
+  double vector3::*axis = &vector3::x;
+  if (d.y > d.x && d.y >= d.z) axis = &vector3::y;
+  if (d.z > d.x && d.z > d.y) axis = &vector3::z;
+
+  const auto left = num_parts / 2;
+  const auto n = static_cast<std::size_t>(last - first);
+  const auto mid = first + static_cast<std::ptrdiff_t>(n * left / num_parts);
+  std::nth_element(first, mid, last, [&](face_index i, face_index j) {
+    const auto ci = centroids[i.get()].*axis;
+    const auto cj = centroids[j.get()].*axis;
+    return ci < cj || (ci == cj && i < j);
+  });
+
+  bisect(centroids, first, mid, part, left, parts);
+  bisect(centroids, mid, last, part + left, num_parts - left, parts);
+}
+
+}  // namespace detail
+
+/// @brief Partitions faces by recursive coordinate bisection
+/// @param[in] mesh Mesh
+/// @param[in] num_parts The number of parts
+/// @return Part id of each face. Invalid faces are assigned invalid_part.
+///
+/// Face centroids are recursively split at the median of the longest side of
+/// their bounding box, so part sizes differ by at most one face per level.
+template <typename Mesh>
+face_property<std::uint32_t> partition_faces(const Mesh& mesh,
+                                             std::uint32_t num_parts) {
+  FMESH_SCOPED_TIMER("fmesh::partition_faces");
+  face_property<std::uint32_t> parts(mesh.num_faces());
+  std::vector<vector3> centroids(mesh.num_faces());
+  std::vector<face_index> faces;
+  faces.reserve(mesh.num_faces());
+  for (auto&& fi : mesh.faces()) {
+    parts[fi] = invalid_part;
+    if (!mesh.is_valid(fi)) continue;
+    centroids[fi.get()] = centroid(mesh, mesh.face(fi));
+    faces.push_back(fi);
+  }
+  if (num_parts > 0)
+    detail::bisect(centroids, faces.begin(), faces.end(), 0, num_parts, parts);
+  return parts;
+}
+
+/// @brief Decomposes a mesh into parts with ghost layers
+/// @param[in] mesh Mesh
+/// @param[in] parts Part id of each face, e.g. from partition_faces()
+/// @param[in] num_parts The number of parts
+/// @param[in] num_ghost_layers The number of layers of ghost faces. Faces
+/// sharing a vertex with the faces of a part form its first layer.
+/// @return Parts ordered by part id
+/// @throw std::invalid_argument If the size of parts differs from the number
+/// of faces, or a valid face has a part id other than invalid_part that is
+/// not less than num_parts
+template <typename Mesh>
+std::vector<submesh<Mesh>> decompose(const Mesh& mesh,
+                                     const face_property<std::uint32_t>& parts,
+                                     std::uint32_t num_parts,
+                                     std::size_t num_ghost_layers = 1) {
+  FMESH_SCOPED_TIMER("fmesh::decompose");
+  using face_type = typename Mesh::face_type;
+  using edge_type = typename Mesh::edge_type;
+
+  if (parts.size() != mesh.num_faces()) {
+    throw std::invalid_argument{
+        "fmesh::decompose: parts must have one entry per face"};
+  }
+  for (auto&& fi : mesh.faces()) {
+    if (mesh.is_valid(fi) && parts[fi] != invalid_part &&
+        parts[fi] >= num_parts) {
+      throw std::invalid_argument{"fmesh::decompose: invalid part id"};
+    }
+  }
+
+  // Vertex and edge owners
+  vertex_property<std::uint32_t> owners(mesh.num_vertices());
+  edge_property<std::uint32_t> edge_owners(mesh.num_edges());
+  for (auto&& vi : mesh.vertices()) owners[vi] = invalid_part;
+  for (auto&& ei : mesh.edges()) edge_owners[ei] = invalid_part;
+  for (auto&& fi : mesh.faces()) {
+    if (!mesh.is_valid(fi) || parts[fi] == invalid_part) continue;
+    for (auto&& vi : mesh.face(fi)) owners[vi] = std::min(owners[vi], parts[fi]);
+    for (auto&& ei : mesh.face_edges(fi))
+      edge_owners[ei] = std::min(edge_owners[ei], parts[fi]);
+  }
+
+  std::vector<std::vector<face_index>> owned(num_parts);
+  for (auto&& fi : mesh.faces())
+    if (mesh.is_valid(fi) && parts[fi] < num_parts)
+      owned[parts[fi]].push_back(fi);
+
+  std::vector<submesh<Mesh>> submeshes(num_parts);
+
+  // Marks entities included in the current part
+  std::vector<std::uint32_t> face_mark(mesh.num_faces(), invalid_part);
+  std::vector<std::uint32_t> vertex_mark(mesh.num_vertices(), invalid_part);
+
+  for (std::uint32_t p = 0; p < num_parts; ++p) {
+    auto& sub = submeshes[p];
+    sub.part = p;
+
+    std::vector<vertex_index> vertices;
+    const auto add_vertices = [&](face_index fi) {
+      for (auto&& vi : mesh.face(fi)) {
+        if (vertex_mark[vi.get()] == p) continue;
+        vertex_mark[vi.get()] = p;
+        vertices.push_back(vi);
+      }
+    };
+    for (auto&& fi : owned[p]) {
+      face_mark[fi.get()] = p;
+      add_vertices(fi);
+    }
+
+    // Grow ghost layers through shared vertices
+    std::vector<face_index> ghosts;
+    std::size_t frontier = 0;
+    for (std::size_t layer = 0; layer < num_ghost_layers; ++layer) {
+      const auto last = vertices.size();
+      for (; frontier < last; ++frontier) {
+        for (auto&& fi : mesh.vertex_faces(vertices[frontier])) {
+          if (!mesh.is_valid(fi) || parts[fi] == invalid_part ||
+              face_mark[fi.get()] == p)
+            continue;
+          face_mark[fi.get()] = p;
+          ghosts.push_back(fi);
+        }
+      }
+      for (std::size_t i = 0; i < ghosts.size(); ++i) add_vertices(ghosts[i]);
+    }
+    std::sort(ghosts.begin(), ghosts.end());
+    std::sort(vertices.begin(), vertices.end());
+
+    // Build the local mesh
+    for (auto&& vi : vertices) {
+      sub.mesh.add_vertex(mesh.vertex(vi));
+      sub.global_vertices.push_back(vi);
+      sub.vertex_owners.push_back(owners[vi]);
+    }
+    const auto add_face = [&](face_index fi) {
+      face_type f = mesh.face(fi);
+      for (auto&& vi : f) vi = sub.to_local(vi);
+      const face_type g = f;
+      sub.mesh.set_current_fracture(mesh.face_fracture(fi));
+      sub.mesh.add_face(g);
+      sub.global_faces.push_back(fi);
+      sub.face_owners.push_back(parts[fi]);
+    };
+    for (auto&& fi : owned[p]) add_face(fi);
+    sub.num_owned_faces = owned[p].size();
+    for (auto&& fi : ghosts) add_face(fi);
+
+    sub.global_edges.resize(sub.mesh.num_edges());
+    sub.edge_owners.resize(sub.mesh.num_edges());
+    for (auto&& ei : sub.mesh.edges()) {
+      const auto& e = sub.mesh.edge(ei);
+      const auto gi = mesh.find(edge_type{sub.global_vertices[e.first],
+                                          sub.global_vertices[e.second]});
+      sub.global_edges[ei] = gi;
+      sub.edge_owners[ei] = edge_owners[gi];
+    }
+  }
+
+  // Exchange plans. Ghosts are visited in increasing global order, so send
+  // and receive lists are ordered consistently.
+  std::vector<std::map<std::uint32_t, halo_exchange>> plans(num_parts);
+  const auto plan = [&](std::uint32_t p, std::uint32_t q) -> halo_exchange& {
+    auto& x = plans[p][q];
+    x.neighbor = q;
+    return x;
+  };
+  for (std::uint32_t p = 0; p < num_parts; ++p) {
+    const auto& sub = submeshes[p];
+    for (auto&& vi : sub.mesh.vertices()) {
+      const auto q = sub.vertex_owners[vi];
+      if (q == p) continue;
+      const auto gi = sub.global_vertices[vi];
+      plan(p, q).recv_vertices.push_back(vi);
+      plan(q, p).send_vertices.push_back(submeshes[q].to_local(gi));
+    }
+    for (auto fi = face_index{sub.num_owned_faces};
+         fi < face_index{sub.mesh.num_faces()}; ++fi) {
+      const auto q = sub.face_owners[fi];
+      const auto gi = sub.global_faces[fi];
+      plan(p, q).recv_faces.push_back(fi);
+      plan(q, p).send_faces.push_back(submeshes[q].to_local(gi));
+    }
+
+    // Local edges are not ordered by global index, so ghost edges are sorted
+    // first. The owner has the edge since it owns one of its faces.
+    std::vector<std::pair<edge_index, edge_index>> ghost_edges;
+    for (auto&& ei : sub.mesh.edges())
+      if (sub.edge_owners[ei] != p)
+        ghost_edges.push_back({sub.global_edges[ei], ei});
+    std::sort(ghost_edges.begin(), ghost_edges.end());
+    for (auto&& [gi, ei] : ghost_edges) {
+      const auto q = sub.edge_owners[ei];
+      const auto& owner = submeshes[q];
+      const auto& e = sub.mesh.edge(ei);
+      plan(p, q).recv_edges.push_back(ei);
+      plan(q, p).send_edges.push_back(owner.mesh.find(
+          edge_type{owner.to_local(sub.global_vertices[e.first]),
+                    owner.to_local(sub.global_vertices[e.second])}));
+    }
+  }
+  for (std::uint32_t p = 0; p < num_parts; ++p)
+    for (auto&& [q, x] : plans[p]) submeshes[p].halo.push_back(std::move(x));
+
+  return submeshes;
+}
+
+/// @brief Decomposes a mesh by recursive coordinate bisection
+/// @param[in] mesh Mesh
+/// @param[in] num_parts The number of parts
+/// @param[in] num_ghost_layers The number of layers of ghost faces
+/// @return Parts ordered by part id
+template <typename Mesh>
+std::vector<submesh<Mesh>> decompose(const Mesh& mesh, std::uint32_t num_parts,
+                                     std::size_t num_ghost_layers = 1) {
+  return decompose(mesh, partition_faces(mesh, num_parts), num_parts,
+                   num_ghost_layers);
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_PARTITION_HPP
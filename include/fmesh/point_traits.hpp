@@ -0,0 +1,44 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_POINT_TRAITS_HPP
+#define FMESH_POINT_TRAITS_HPP
+
+namespace fmesh {
+
+/// @brief Adapts a user-defined point type to the geometric algorithms
+///
+/// The default implementation expects public members `x`, `y`, and `z` and a
+/// point constructible from three coordinates as `Point{x, y, z}`. Specialize
+/// this class template for other point types.
+template <typename Point>
+struct point_traits {
+  static double x(const Point& p) noexcept { return p.x; }
+  static double y(const Point& p) noexcept { return p.y; }
+  static double z(const Point& p) noexcept { return p.z; }
+
+  static Point make(double x, double y, double z) { return Point{x, y, z}; }
+};
+
+}  // namespace fmesh
+
+#endif  // FMESH_POINT_TRAITS_HPP
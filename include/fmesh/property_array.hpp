@@ -24,6 +24,7 @@
 #define FMESH_PROPERTY_ARRAY_HPP
 
 #include <cassert>
+#include <utility>
 #include <vector>
 
 #include "fmesh/index.hpp"
@@ -58,7 +59,7 @@ class property_array : public property_array_base<Key> {
   using base_type = property_array_base<Key>;
 
   property_array() = default;
-  property_array(size_type size) : base_type{}, values_{size} {}
+  property_array(size_type size) : base_type{}, values_(size) {}
   property_array(std::initializer_list<T> list) : base_type{}, values_{list} {}
   property_array(const property_array&) = default;
   property_array(property_array&&) = default;
@@ -71,10 +72,18 @@ class property_array : public property_array_base<Key> {
   bool empty() const noexcept { return values_.empty(); }
   size_type size() const noexcept { return values_.size(); }
   void resize(size_type size) { values_.resize(size); }
+  void resize(size_type size, const T& value) { values_.resize(size, value); }
   void reserve(size_type capacity) { values_.reserve(capacity); }
   size_type capacity() const noexcept { return values_.capacity(); }
+  void shrink_to_fit() { values_.shrink_to_fit(); }
   void clear() { values_.clear(); }
 
+  /// @brief Returns the underlying contiguous array
+  ///
+  /// Not available for bool values.
+  pointer data() noexcept { return values_.data(); }
+  const_pointer data() const noexcept { return values_.data(); }
+
   iterator begin() noexcept { return values_.begin(); }
   const_iterator begin() const noexcept { return values_.begin(); }
   iterator end() noexcept { return values_.end(); }
@@ -106,6 +115,86 @@ class property_array : public property_array_base<Key> {
   array_type values_;
 };
 
+/// @brief Moves values to new indices and removes the others
+/// @param[in,out] values Property array to be compacted
+/// @param[in] map Map from old to new indices. Values mapped to invalid indices
+/// are removed.
+///
+/// New indices must be a permutation of [0, n), where n is the number of
+/// valid indices in the map. Values are moved in place if new indices preserve
+/// the order of old indices, and through a temporary array otherwise, e.g.
+/// when faces are grouped by fracture.
+template <typename Key, typename T, typename Allocator>
+void compact(property_array<Key, T, Allocator>& values,
+             const property_array<Key, Key>& map) {
+  assert(values.size() == map.size());
+  std::size_t n = 0;
+  bool is_ordered = true;
+  for (auto&& j : map) {
+    if (!j.is_valid()) continue;
+    is_ordered = is_ordered && j == Key{n};
+    ++n;
+  }
+
+  if (is_ordered) {
+    for (Key i{0}; i < Key{map.size()}; ++i) {
+      const auto j = map[i];
+      if (j.is_valid() && j != i) values[j] = std::move(values[i]);
+    }
+    values.resize(n);
+    return;
+  }
+
+  property_array<Key, T, Allocator> moved(n);
+  for (Key i{0}; i < Key{map.size()}; ++i) {
+    const auto j = map[i];
+    if (j.is_valid()) moved[j] = std::move(values[i]);
+  }
+  values = std::move(moved);
+}
+
+/// @brief Copies values of given keys to an output iterator
+/// @param[in] values Property array
+/// @param[in] keys Range of keys, e.g. vertices of a face
+/// @param[out] out Output iterator
+/// @return Output iterator past the last copied value
+///
+/// Values are only read, so calls for different entities can run
+/// concurrently.
+template <typename Key, typename T, typename Allocator, typename Keys,
+          typename OutputIterator>
+OutputIterator gather(const property_array<Key, T, Allocator>& values,
+                      const Keys& keys, OutputIterator out) {
+  const auto first = values.begin();
+  for (auto&& key : keys) {
+    assert(static_cast<std::size_t>(key) < values.size());
+    *out++ = first[static_cast<std::size_t>(key)];
+  }
+  return out;
+}
+
+/// @brief Adds contributions to values of given keys
+/// @param[in,out] values Property array
+/// @param[in] keys Range of keys. Keys can be repeated.
+/// @param[in] contributions Range of values added to each key in order
+///
+/// Contributions to the same key are accumulated in order, so results do
+/// not depend on how calls are batched. Concurrent calls must not share
+/// keys; scatter_add() of colouring.hpp runs calls for entities of a
+/// colouring in parallel.
+template <typename Key, typename T, typename Allocator, typename Keys,
+          typename Contributions>
+void scatter_add(property_array<Key, T, Allocator>& values, const Keys& keys,
+                 const Contributions& contributions) {
+  const auto first = values.begin();
+  auto it = contributions.begin();
+  for (auto&& key : keys) {
+    assert(static_cast<std::size_t>(key) < values.size());
+    assert(it != contributions.end());
+    first[static_cast<std::size_t>(key)] += *it++;
+  }
+}
+
 template <typename T, typename Allocator = std::allocator<T>>
 using vertex_property = property_array<vertex_index, T, Allocator>;
 
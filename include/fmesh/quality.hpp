@@ -0,0 +1,317 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_QUALITY_HPP
+#define FMESH_QUALITY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Face quality metrics
+enum class quality_metric {
+  /// Longest edge times perimeter divided by area, normalized to one for
+  /// equilateral triangles and squares. Larger is worse.
+  aspect_ratio,
+  /// The smallest interior angle in degrees. Smaller is worse.
+  min_angle,
+  /// Longest edge divided by shortest edge. Larger is worse.
+  edge_ratio,
+  /// Equiangle skewness in [0, 1], zero for equilateral triangles and
+  /// squares. Larger is worse.
+  skewness,
+};
+
+/// @brief The number of quality metrics
+inline constexpr std::size_t num_quality_metrics = 4;
+
+/// @brief Options of compute_quality()
+struct quality_options {
+  /// The number of histogram bins
+  std::size_t num_bins = 10;
+  /// The number of worst faces reported for each metric
+  std::size_t num_worst = 10;
+  /// Histogram range [lower, upper] of each metric, indexed by quality_metric.
+  /// Values outside are counted in the first or last bin.
+  std::array<std::array<double, 2>, num_quality_metrics> ranges = {
+      {{1.0, 5.0}, {0.0, 90.0}, {1.0, 5.0}, {0.0, 1.0}}};
+};
+
+/// @brief Summary of a quality metric over valid faces
+struct quality_summary {
+  /// The smallest value
+  double min = std::numeric_limits<double>::infinity();
+  /// The largest value
+  double max = -std::numeric_limits<double>::infinity();
+  /// The mean value
+  double mean = 0.0;
+  /// Counts of values in equal bins of quality_options::ranges
+  std::vector<std::size_t> histogram;
+  /// The worst faces, the worst first. Ties are broken by face index.
+  std::vector<face_index> worst;
+};
+
+/// @brief Per-face quality metrics and their summaries
+///
+/// Metrics of invalid faces are NaN.
+struct quality_report {
+  face_property<double> aspect_ratios;
+  face_property<double> min_angles;
+  face_property<double> edge_ratios;
+  face_property<double> skewness;
+  /// Summaries indexed by quality_metric
+  std::array<quality_summary, num_quality_metrics> summaries;
+
+  /// @brief Returns the values of a metric
+  const face_property<double>& values(quality_metric m) const noexcept {
+    switch (m) {
+      case quality_metric::aspect_ratio:
+        return aspect_ratios;
+      case quality_metric::min_angle:
+        return min_angles;
+      case quality_metric::edge_ratio:
+        return edge_ratios;
+      default:
+        return skewness;
+    }
+  }
+
+  /// @brief Returns the summary of a metric
+  const quality_summary& summary(quality_metric m) const noexcept {
+    return summaries[static_cast<std::size_t>(m)];
+  }
+};
+
+namespace detail {
+
+/// @brief Computes quality metrics of a face
+/// @return Metrics indexed by quality_metric
+template <typename Mesh>
+std::array<double, num_quality_metrics> face_quality(
+    const Mesh& mesh, const typename Mesh::face_type& f) {
+  constexpr auto N = Mesh::face_type::num_vertices;
+  constexpr double pi = 3.14159265358979323846;
+  constexpr double ideal_angle = 180.0 * (N - 2) / N;
+
+  std::array<vector3, N> p;
+  for (std::size_t k = 0; k < N; ++k) p[k] = to_vector3(mesh.vertex(f[k]));
+  std::array<vector3, N> e;
+  std::array<double, N> lengths;
+  for (std::size_t k = 0; k < N; ++k) {
+    e[k] = p[(k + 1) % N] - p[k];
+    lengths[k] = norm(e[k]);
+  }
+
+  double min_angle = 180.0;
+  double max_angle = 0.0;
+  for (std::size_t k = 0; k < N; ++k) {
+    const auto& u = e[k];
+    const auto v = -e[(k + N - 1) % N];
+    const auto angle = std::atan2(norm(cross(u, v)), dot(u, v)) * 180.0 / pi;
+    min_angle = std::min(min_angle, angle);
+    max_angle = std::max(max_angle, angle);
+  }
+
+  double perimeter = 0.0;
+  double lmin = lengths[0];
+  double lmax = lengths[0];
+  for (auto&& l : lengths) {
+    perimeter += l;
+    lmin = std::min(lmin, l);
+    lmax = std::max(lmax, l);
+  }
+
+  // Normalizes aspect ratios by 4 sqrt(3) for triangles and 4 for squares.
+  constexpr double scale = N == 3 ? 6.92820323027550917 : 4.0;
+  const auto area = norm(area_vector(mesh, f));
+  constexpr auto inf = std::numeric_limits<double>::infinity();
+
+  std::array<double, num_quality_metrics> q;
+  q[0] = area > 0.0 ? lmax * perimeter / (scale * area) : inf;
+  q[1] = min_angle;
+  q[2] = lmin > 0.0 ? lmax / lmin : inf;
+  q[3] = std::max((max_angle - ideal_angle) / (180.0 - ideal_angle),
+                  (ideal_angle - min_angle) / ideal_angle);
+  return q;
+}
+
+/// @brief Returns true if metric m is worse for value a than for value b
+inline bool is_worse(std::size_t m, double a, double b) noexcept {
+  return m == static_cast<std::size_t>(quality_metric::min_angle) ? a < b
+                                                                  : a > b;
+}
+
+/// @brief Returns the histogram bin of a value, clamped to the end bins
+inline std::size_t histogram_bin(double value,
+                                 const std::array<double, 2>& range,
+                                 std::size_t num_bins) noexcept {
+  const auto x = (value - range[0]) / (range[1] - range[0]);
+  if (!(x > 0.0)) return 0;
+  const auto n = static_cast<double>(num_bins);
+  return x * n < n ? static_cast<std::size_t>(x * n) : num_bins - 1;
+}
+
+/// @brief Partial summaries of a contiguous chunk of faces
+struct quality_partial {
+  std::array<double, num_quality_metrics> min;
+  std::array<double, num_quality_metrics> max;
+  std::array<double, num_quality_metrics> sum;
+  std::size_t count = 0;
+  std::array<std::vector<std::size_t>, num_quality_metrics> histograms;
+  std::array<std::vector<face_index>, num_quality_metrics> worst;
+};
+
+}  // namespace detail
+
+/// @brief Computes quality metrics of valid faces and their summaries
+/// @param[in] mesh Mesh of triangles or quadrilaterals
+/// @param[out] report Report. Its arrays are reused if already allocated.
+/// @param[in] options Options
+///
+/// Faces are processed in parallel in chunks. Each chunk writes its metrics
+/// and accumulates its own histograms and worst faces, which are merged in
+/// chunk order, so the report does not depend on the number of threads.
+template <typename Mesh>
+void compute_quality(const Mesh& mesh, quality_report& report,
+                     const quality_options& options = {}) {
+  FMESH_SCOPED_TIMER("fmesh::compute_quality");
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  constexpr auto inf = std::numeric_limits<double>::infinity();
+  constexpr std::size_t grain = 4096;
+  const auto nf = mesh.num_faces();
+  const auto num_bins = std::max<std::size_t>(options.num_bins, 1);
+  const auto num_worst = options.num_worst;
+
+  std::array<face_property<double>*, num_quality_metrics> values = {
+      &report.aspect_ratios, &report.min_angles, &report.edge_ratios,
+      &report.skewness};
+  for (auto&& v : values) v->resize(nf);
+
+  const auto keep_worst = [&values, num_worst](std::size_t m,
+                                               std::vector<face_index>& fs) {
+    const auto& v = *values[m];
+    const auto worse = [&v, m](face_index a, face_index b) {
+      if (v[a] != v[b]) return detail::is_worse(m, v[a], v[b]);
+      return a < b;
+    };
+    if (fs.size() > num_worst) {
+      std::nth_element(fs.begin(),
+                       fs.begin() + static_cast<std::ptrdiff_t>(num_worst),
+                       fs.end(), worse);
+      fs.resize(num_worst);
+    }
+    std::sort(fs.begin(), fs.end(), worse);
+  };
+
+  const auto num_chunks = (nf + grain - 1) / grain;
+  std::vector<detail::quality_partial> partials(num_chunks);
+  std::vector<std::size_t> chunks(num_chunks);
+  for (std::size_t c = 0; c < num_chunks; ++c) chunks[c] = c;
+  parallel_for(
+      chunks,
+      [&](std::size_t c) {
+        auto& part = partials[c];
+        part.min.fill(inf);
+        part.max.fill(-inf);
+        part.sum.fill(0.0);
+        for (auto&& h : part.histograms) h.assign(num_bins, 0);
+
+        const auto end = std::min(nf, (c + 1) * grain);
+        for (face_index fi{c * grain}; fi < face_index{end}; ++fi) {
+          if (!mesh.is_valid(fi)) {
+            for (auto&& v : values) (*v)[fi] = nan;
+            continue;
+          }
+          const auto q = detail::face_quality(mesh, mesh.face(fi));
+          ++part.count;
+          for (std::size_t m = 0; m < num_quality_metrics; ++m) {
+            (*values[m])[fi] = q[m];
+            part.min[m] = std::min(part.min[m], q[m]);
+            part.max[m] = std::max(part.max[m], q[m]);
+            part.sum[m] += q[m];
+
+            ++part.histograms[m][detail::histogram_bin(
+                q[m], options.ranges[m], num_bins)];
+
+            if (num_worst == 0) continue;
+            auto& worst = part.worst[m];
+            worst.push_back(fi);
+            if (worst.size() >= 2 * num_worst) keep_worst(m, worst);
+          }
+        }
+        for (std::size_t m = 0; m < num_quality_metrics; ++m)
+          keep_worst(m, part.worst[m]);
+      },
+      1);
+
+  std::size_t count = 0;
+  for (std::size_t m = 0; m < num_quality_metrics; ++m) {
+    auto& s = report.summaries[m];
+    s = quality_summary{};
+    s.histogram.assign(num_bins, 0);
+  }
+  for (auto&& part : partials) {
+    count += part.count;
+    for (std::size_t m = 0; m < num_quality_metrics; ++m) {
+      auto& s = report.summaries[m];
+      s.min = std::min(s.min, part.min[m]);
+      s.max = std::max(s.max, part.max[m]);
+      s.mean += part.sum[m];
+      for (std::size_t b = 0; b < num_bins; ++b)
+        s.histogram[b] += part.histograms[m][b];
+      s.worst.insert(s.worst.end(), part.worst[m].begin(),
+                     part.worst[m].end());
+    }
+  }
+  for (std::size_t m = 0; m < num_quality_metrics; ++m) {
+    auto& s = report.summaries[m];
+    s.mean = count > 0 ? s.mean / static_cast<double>(count) : nan;
+    keep_worst(m, s.worst);
+  }
+}
+
+/// @brief Computes quality metrics of valid faces and their summaries
+/// @param[in] mesh Mesh of triangles or quadrilaterals
+/// @param[in] options Options
+template <typename Mesh>
+quality_report compute_quality(const Mesh& mesh,
+                               const quality_options& options = {}) {
+  quality_report report;
+  compute_quality(mesh, report, options);
+  return report;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_QUALITY_HPP
@@ -0,0 +1,288 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_REFINEMENT_HPP
+#define FMESH_REFINEMENT_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/iterator_range.hpp"
+#include "fmesh/parallel.hpp"
+
+namespace fmesh {
+
+/// @brief Mesh entities created and removed by refine()
+struct refinement_result {
+  /// New vertices at edge midpoints and quadrilateral centers
+  std::vector<vertex_index> new_vertices;
+  /// New child faces
+  std::vector<face_index> new_faces;
+  /// Parent faces, which are invalidated after refinement
+  std::vector<face_index> refined_faces;
+};
+
+namespace detail {
+
+struct no_vertex_prolongation {
+  template <typename Range>
+  void operator()(vertex_index, const Range&) const noexcept {}
+};
+
+struct no_face_prolongation {
+  void operator()(face_index, face_index) const noexcept {}
+};
+
+}  // namespace detail
+
+/// @brief Refines marked faces while keeping the mesh conforming
+/// @param[in,out] mesh Mesh of tri_face or quad_face
+/// @param[in] marked Faces to be refined
+/// @param[in] prolongate_vertex Function called as `f(vi, parents)` for each
+/// new vertex, where `parents` is a range of the vertices it is averaged from
+/// @param[in] prolongate_face Function called as `f(child, parent)` for each
+/// new face
+/// @return New vertices and faces, and refined parent faces
+///
+/// Triangles are refined by red-green refinement. Marked triangles and
+/// triangles with two or more split edges are split into four (red), and
+/// triangles with one split edge are bisected (green).
+///
+/// Marked quadrilaterals are split into four. A quadrilateral whose split
+/// edges all belong to one pair of opposite edges is split into two across
+/// that pair instead, which may propagate along a sheet of quadrilaterals.
+///
+/// Every valid face sharing a split edge is refined, so the result is
+/// conforming at branching edges as well. Child faces are appended to the
+/// mesh before their parents are invalidated. Properties must be resized by
+/// the prolongation functions before being written.
+///
+/// Positions of new vertices and child faces are computed in parallel. The
+/// closure runs on the calling thread, since it is a worklist in which
+/// splitting an edge affects every face around it. So do add_vertex(),
+/// add_face(), and the prolongation functions, since each new face updates
+/// vertex and edge adjacency shared with its neighbors.
+template <typename Mesh, typename VertexFunction, typename FaceFunction>
+refinement_result refine(Mesh& mesh, const std::vector<face_index>& marked,
+                         VertexFunction&& prolongate_vertex,
+                         FaceFunction&& prolongate_face) {
+  FMESH_SCOPED_TIMER("fmesh::refine");
+  using face_type = typename Mesh::face_type;
+  constexpr auto N = face_type::num_vertices;
+  static_assert(N == 3 || N == 4,
+                "Only triangular and quadrilateral faces are supported.");
+
+  // Face states
+  constexpr std::uint8_t untouched = 0;
+  constexpr std::uint8_t red = 1;
+  constexpr std::uint8_t affected = 2;
+
+  const auto current = mesh.current_fracture();
+  std::vector<std::uint8_t> state(mesh.num_faces(), untouched);
+  std::vector<vertex_index> midpoints(mesh.num_edges());
+  std::vector<edge_index> split_edges;
+
+  const auto split = [&](edge_index ei) {
+    if (midpoints[ei.get()].is_valid()) return;
+    // Temporarily mark the edge; the midpoint is created later.
+    midpoints[ei.get()] = vertex_index{0};
+    split_edges.push_back(ei);
+  };
+  const auto is_split = [&](edge_index ei) {
+    return midpoints[ei.get()].is_valid();
+  };
+  const auto make_red = [&](face_index fi) {
+    if (state[fi.get()] == red) return;
+    state[fi.get()] = red;
+    for (auto&& ei : mesh.face_edges(fi)) split(ei);
+  };
+
+  for (auto&& fi : marked)
+    if (mesh.is_valid(fi)) make_red(fi);
+
+  // Closure: split edges until every face has an admissible pattern.
+  for (std::size_t k = 0; k < split_edges.size(); ++k) {
+    for (auto&& fi : mesh.edge_faces(split_edges[k])) {
+      if (!mesh.is_valid(fi) || state[fi.get()] == red) continue;
+      state[fi.get()] = affected;
+
+      const auto es = mesh.face_edges(fi).begin();
+      if constexpr (N == 3) {
+        const auto n = is_split(es[0]) + is_split(es[1]) + is_split(es[2]);
+        if (n >= 2) make_red(fi);
+      } else {
+        const bool a = is_split(es[0]) || is_split(es[2]);
+        const bool b = is_split(es[1]) || is_split(es[3]);
+        if (a && b) {
+          make_red(fi);
+        } else if (a) {
+          split(es[0]);
+          split(es[2]);
+        } else if (b) {
+          split(es[1]);
+          split(es[3]);
+        }
+      }
+    }
+  }
+
+  refinement_result result;
+  const auto nv = mesh.num_vertices();
+
+  // Refined faces in index order, and the centers of red quadrilaterals
+  // numbered after all midpoints
+  auto& refined = result.refined_faces;
+  std::vector<vertex_index> centers;
+  std::size_t num_centers = 0;
+  for (std::size_t i = 0; i < state.size(); ++i) {
+    if (state[i] == untouched) continue;
+    refined.push_back(face_index{i});
+    if constexpr (N == 4) {
+      const auto k = nv + split_edges.size() + num_centers;
+      centers.push_back(state[i] == red ? vertex_index{k} : vertex_index{});
+      num_centers += state[i] == red;
+    }
+  }
+
+  // Positions of new vertices
+  std::vector<vector3> positions(split_edges.size() + num_centers);
+  std::vector<std::size_t> ids(split_edges.size());
+  for (std::size_t k = 0; k < ids.size(); ++k) {
+    ids[k] = k;
+    midpoints[split_edges[k].get()] = vertex_index{nv + k};
+  }
+  parallel_for(ids, [&](std::size_t k) {
+    const auto& e = mesh.edge(split_edges[k]);
+    positions[k] = 0.5 * (to_vector3(mesh.vertex(e.first)) +
+                          to_vector3(mesh.vertex(e.second)));
+  });
+
+  // Child faces of each refined face
+  std::vector<std::array<face_type, 4>> children(refined.size());
+  std::vector<std::uint8_t> num_children(refined.size());
+  ids.resize(refined.size());
+  for (std::size_t k = 0; k < ids.size(); ++k) ids[k] = k;
+  parallel_for(ids, [&](std::size_t k) {
+    const auto fi = refined[k];
+    const face_type f = mesh.face(fi);
+    std::array<vertex_index, N> m;
+    const auto es = mesh.face_edges(fi).begin();
+    for (std::size_t j = 0; j < N; ++j) m[j] = midpoints[es[j].get()];
+
+    auto& cs = children[k];
+    auto& n = num_children[k];
+    const bool is_red = state[fi.get()] == red;
+    if constexpr (N == 3) {
+      if (is_red) {
+        cs = {{{f[0], m[0], m[2]},
+               {m[0], f[1], m[1]},
+               {m[2], m[1], f[2]},
+               {m[0], m[1], m[2]}}};
+        n = 4;
+      } else {
+        for (std::size_t j = 0; j < 3; ++j) {
+          if (!m[j].is_valid()) continue;
+          const auto v0 = f[j];
+          const auto v1 = f[(j + 1) % 3];
+          const auto v2 = f[(j + 2) % 3];
+          cs[0] = {v0, m[j], v2};
+          cs[1] = {m[j], v1, v2};
+          n = 2;
+        }
+      }
+    } else {
+      if (is_red) {
+        const auto c = centers[k];
+        vector3 p;
+        for (auto&& vi : f) p += to_vector3(mesh.vertex(vi));
+        positions[c.get() - nv] = p / static_cast<double>(N);
+        cs = {{{f[0], m[0], c, m[3]},
+               {m[0], f[1], m[1], c},
+               {c, m[1], f[2], m[2]},
+               {m[3], c, m[2], f[3]}}};
+        n = 4;
+      } else if (m[0].is_valid()) {
+        cs[0] = {f[0], m[0], m[2], f[3]};
+        cs[1] = {m[0], f[1], f[2], m[2]};
+        n = 2;
+      } else {
+        cs[0] = {f[0], f[1], m[1], m[3]};
+        cs[1] = {m[3], m[1], f[2], f[3]};
+        n = 2;
+      }
+    }
+  });
+
+  // Create midpoints of split edges and centers of quadrilaterals
+  using point_type = typename Mesh::point_type;
+  for (std::size_t k = 0; k < positions.size(); ++k) {
+    const auto vi = mesh.add_vertex(to_point<point_type>(positions[k]));
+    result.new_vertices.push_back(vi);
+    if (k < split_edges.size()) {
+      const auto e = mesh.edge(split_edges[k]);
+      const std::array<vertex_index, 2> parents{e.first, e.second};
+      prolongate_vertex(vi, make_iterator_range(parents.data(),
+                                                parents.data() + 2));
+    }
+  }
+  if constexpr (N == 4) {
+    for (std::size_t k = 0; k < refined.size(); ++k) {
+      if (!centers[k].is_valid()) continue;
+      const auto& f = mesh.face(refined[k]);
+      prolongate_vertex(centers[k],
+                        make_iterator_range(f.data(), f.data() + N));
+    }
+  }
+
+  // Create child faces. Children stay in the fracture of their parent.
+  for (std::size_t k = 0; k < refined.size(); ++k) {
+    const auto fi = refined[k];
+    mesh.set_current_fracture(mesh.face_fracture(fi));
+    for (std::size_t j = 0; j < num_children[k]; ++j) {
+      const auto ci = mesh.add_face(children[k][j]);
+      result.new_faces.push_back(ci);
+      prolongate_face(ci, fi);
+    }
+  }
+
+  for (auto&& fi : result.refined_faces) mesh.invalidate(fi);
+  mesh.set_current_fracture(current);
+
+  return result;
+}
+
+/// @brief Refines marked faces while keeping the mesh conforming
+/// @param[in,out] mesh Mesh of tri_face or quad_face
+/// @param[in] marked Faces to be refined
+template <typename Mesh>
+refinement_result refine(Mesh& mesh, const std::vector<face_index>& marked) {
+  return refine(mesh, marked, detail::no_vertex_prolongation{},
+                detail::no_face_prolongation{});
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_REFINEMENT_HPP
@@ -0,0 +1,184 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_SPARSITY_HPP
+#define FMESH_SPARSITY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+
+namespace fmesh {
+
+/// @brief Sparsity pattern in compressed sparse row (CSR) format
+/// @tparam Index Integer type of row offsets and column indices, e.g. PetscInt
+/// or the StorageIndex of Eigen
+///
+/// Column indices of each row are sorted in increasing order without
+/// duplicates.
+template <typename Index = std::size_t>
+struct sparsity_pattern {
+  using index_type = Index;
+
+  /// Offsets of rows in columns. The size is num_rows() + 1.
+  std::vector<Index> row_offsets;
+  /// Column indices
+  std::vector<Index> columns;
+  /// The number of columns of the matrix
+  std::size_t num_columns = 0;
+
+  std::size_t num_rows() const noexcept {
+    return row_offsets.empty() ? 0 : row_offsets.size() - 1;
+  }
+  std::size_t num_nonzeros() const noexcept { return columns.size(); }
+};
+
+namespace detail {
+
+/// @brief Builds a pattern from a function appending columns of a row
+/// @param[in] grain The number of rows built by a task
+///
+/// The function is called as `f(i, columns)` from several threads and may
+/// append duplicated column indices in any order.
+///
+/// Each chunk of rows is built into its own buffer in parallel, which gives
+/// the row lengths. Row offsets are their prefix sum, and chunks are then
+/// copied to their offsets in parallel. The result does not depend on the
+/// number of threads.
+template <typename Index, typename RowFunction>
+sparsity_pattern<Index> make_pattern(std::size_t num_rows,
+                                     std::size_t num_columns,
+                                     RowFunction&& append_row,
+                                     std::size_t grain = 1024) {
+  FMESH_SCOPED_TIMER("fmesh::sparsity_pattern");
+  sparsity_pattern<Index> pattern;
+  pattern.num_columns = num_columns;
+  auto& offsets = pattern.row_offsets;
+  offsets.assign(num_rows + 1, 0);
+
+  const auto num_chunks = (num_rows + grain - 1) / grain;
+  std::vector<std::vector<Index>> buffers(num_chunks);
+  std::vector<std::size_t> chunks(num_chunks);
+  std::iota(chunks.begin(), chunks.end(), std::size_t{0});
+  parallel_for(
+      chunks,
+      [&](std::size_t c) {
+        auto& columns = buffers[c];
+        const auto end = std::min(num_rows, (c + 1) * grain);
+        for (auto i = c * grain; i < end; ++i) {
+          const auto first = columns.size();
+          append_row(i, columns);
+          const auto begin = columns.begin() + first;
+          std::sort(begin, columns.end());
+          columns.erase(std::unique(begin, columns.end()), columns.end());
+          offsets[i + 1] = static_cast<Index>(columns.size() - first);
+        }
+      },
+      1);
+
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  pattern.columns.resize(static_cast<std::size_t>(offsets.back()));
+  parallel_for(
+      chunks,
+      [&](std::size_t c) {
+        auto& columns = buffers[c];
+        std::copy(columns.begin(), columns.end(),
+                  pattern.columns.begin() + offsets[c * grain]);
+        std::vector<Index>{}.swap(columns);
+      },
+      1);
+  return pattern;
+}
+
+}  // namespace detail
+
+/// @brief Returns the vertex-vertex sparsity pattern
+/// @param[in] mesh Mesh
+/// @param[in] include_diagonal Includes diagonal entries of valid vertices?
+///
+/// Vertices are coupled if they share a valid face, as in finite element
+/// assembly. Rows of invalid vertices are empty. Compact the mesh first to
+/// hand the pattern to a solver.
+template <typename Index = std::size_t, typename Mesh>
+sparsity_pattern<Index> vertex_vertex_pattern(const Mesh& mesh,
+                                              bool include_diagonal = true) {
+  const auto n = mesh.num_vertices();
+  mesh.build_caches();
+  return detail::make_pattern<Index>(n, n, [&](std::size_t i, auto& columns) {
+    const vertex_index vi{i};
+    if (!mesh.is_valid(vi)) return;
+    if (include_diagonal) columns.push_back(static_cast<Index>(i));
+    for (auto&& fi : mesh.vertex_faces(vi)) {
+      if (!mesh.is_valid(fi)) continue;
+      for (auto&& vj : mesh.face(fi))
+        if (vj != vi) columns.push_back(static_cast<Index>(vj.get()));
+    }
+  });
+}
+
+/// @brief Returns the face-face sparsity pattern
+/// @param[in] mesh Mesh
+/// @param[in] include_diagonal Includes diagonal entries of valid faces?
+///
+/// Faces are coupled if they share a valid edge. All faces at a branching edge
+/// are coupled with each other. Rows of invalid faces are empty.
+template <typename Index = std::size_t, typename Mesh>
+sparsity_pattern<Index> face_face_pattern(const Mesh& mesh,
+                                          bool include_diagonal = true) {
+  const auto n = mesh.num_faces();
+  return detail::make_pattern<Index>(n, n, [&](std::size_t i, auto& columns) {
+    const face_index fi{i};
+    if (!mesh.is_valid(fi)) return;
+    if (include_diagonal) columns.push_back(static_cast<Index>(i));
+    for (auto&& ei : mesh.face_edges(fi)) {
+      for (auto&& fj : mesh.edge_faces(ei))
+        if (fj != fi && mesh.is_valid(fj))
+          columns.push_back(static_cast<Index>(fj.get()));
+    }
+  });
+}
+
+/// @brief Returns the vertex-face sparsity pattern
+/// @param[in] mesh Mesh
+///
+/// A vertex is coupled with the valid faces containing it. The pattern has a
+/// row for each vertex and a column for each face.
+template <typename Index = std::size_t, typename Mesh>
+sparsity_pattern<Index> vertex_face_pattern(const Mesh& mesh) {
+  mesh.build_caches();
+  return detail::make_pattern<Index>(
+      mesh.num_vertices(), mesh.num_faces(), [&](std::size_t i, auto& columns) {
+        const vertex_index vi{i};
+        if (!mesh.is_valid(vi)) return;
+        for (auto&& fi : mesh.vertex_faces(vi))
+          if (mesh.is_valid(fi)) columns.push_back(static_cast<Index>(fi.get()));
+      });
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_SPARSITY_HPP
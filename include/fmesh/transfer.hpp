@@ -0,0 +1,509 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_TRANSFER_HPP
+#define FMESH_TRANSFER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+
+namespace fmesh {
+
+/// @brief Interpolation methods of property transfer
+enum class transfer_method {
+  /// Copies the value of the nearest source face or vertex
+  nearest,
+  /// Interpolates vertex values linearly at the closest point on the source
+  /// mesh. Applies to vertex properties.
+  linear,
+  /// Averages face values weighted by overlap areas, which preserves integrals
+  /// over the surface. Applies to face properties.
+  conservative,
+};
+
+/// @brief Options of property transfer
+struct transfer_options {
+  /// Source faces overlap a target face in conservative transfer only if their
+  /// vertices are closer to the plane of the target face than this distance.
+  /// If zero, a quarter of the cell size of the locator is used.
+  double distance_tolerance = 0.0;
+  /// Source faces overlap a target face in conservative transfer only if the
+  /// absolute cosine of the angle between their normals is at least this
+  /// value, so that crossing fractures do not mix at branches.
+  double normal_tolerance = 0.9;
+};
+
+/// @brief Closest point on a mesh
+template <std::size_t N>
+struct mesh_location {
+  /// Face containing the point, or an invalid index if the mesh is empty
+  face_index face;
+  /// Barycentric weights of the vertices of the face
+  std::array<double, N> weights{};
+  /// Distance from the query point
+  double distance = std::numeric_limits<double>::infinity();
+};
+
+namespace detail {
+
+/// @brief Returns barycentric weights of the point on triangle abc closest to
+/// p
+inline std::array<double, 3> closest_point_on_triangle(
+    const vector3& p, const vector3& a, const vector3& b,
+    const vector3& c) noexcept {
+  const auto ab = b - a;
+  const auto ac = c - a;
+  const auto ap = p - a;
+  const auto d1 = dot(ab, ap);
+  const auto d2 = dot(ac, ap);
+  if (d1 <= 0.0 && d2 <= 0.0) return {1.0, 0.0, 0.0};
+
+  const auto bp = p - b;
+  const auto d3 = dot(ab, bp);
+  const auto d4 = dot(ac, bp);
+  if (d3 >= 0.0 && d4 <= d3) return {0.0, 1.0, 0.0};
+
+  const auto vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+    const auto v = d1 / (d1 - d3);
+    return {1.0 - v, v, 0.0};
+  }
+
+  const auto cp = p - c;
+  const auto d5 = dot(ab, cp);
+  const auto d6 = dot(ac, cp);
+  if (d6 >= 0.0 && d5 <= d6) return {0.0, 0.0, 1.0};
+
+  const auto vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+    const auto w = d2 / (d2 - d6);
+    return {1.0 - w, 0.0, w};
+  }
+
+  const auto va = d3 * d6 - d5 * d4;
+  if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+    const auto w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    return {0.0, 1.0 - w, w};
+  }
+
+  const auto denom = 1.0 / (va + vb + vc);
+  const auto v = vb * denom;
+  const auto w = vc * denom;
+  return {1.0 - v - w, v, w};
+}
+
+/// @brief Convex polygon in a plane with at most eight vertices
+struct polygon2 {
+  std::array<std::array<double, 2>, 8> points;
+  std::size_t size = 0;
+
+  double area() const noexcept {
+    double a = 0.0;
+    for (std::size_t k = 0; k < size; ++k) {
+      const auto& p = points[k];
+      const auto& q = points[(k + 1) % size];
+      a += p[0] * q[1] - q[0] * p[1];
+    }
+    return 0.5 * a;
+  }
+};
+
+/// @brief Clips a polygon by the left side of the line from a to b
+inline polygon2 clip(const polygon2& poly, const std::array<double, 2>& a,
+                     const std::array<double, 2>& b) noexcept {
+  const auto side = [&a, &b](const std::array<double, 2>& p) {
+    return (b[0] - a[0]) * (p[1] - a[1]) - (b[1] - a[1]) * (p[0] - a[0]);
+  };
+  polygon2 result;
+  for (std::size_t k = 0; k < poly.size; ++k) {
+    const auto& p = poly.points[k];
+    const auto& q = poly.points[(k + 1) % poly.size];
+    const auto sp = side(p);
+    const auto sq = side(q);
+    if (sp >= 0.0 && result.size < result.points.size())
+      result.points[result.size++] = p;
+    if ((sp >= 0.0) != (sq >= 0.0) && result.size < result.points.size()) {
+      const auto t = sp / (sp - sq);
+      result.points[result.size++] = {p[0] + t * (q[0] - p[0]),
+                                      p[1] + t * (q[1] - p[1])};
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
+/// @brief Spatial index of faces for closest-point and overlap queries
+///
+/// Faces are registered in all cells of a uniform grid overlapped by their
+/// bounding boxes. Queries only read the index and the mesh, so they can be
+/// run in parallel. The mesh must outlive the locator and must not be modified.
+template <typename Mesh>
+class face_locator {
+ public:
+  static constexpr auto num_face_vertices = Mesh::face_type::num_vertices;
+  using location_type = mesh_location<num_face_vertices>;
+
+  /// @brief Builds the index of valid faces
+  /// @param[in] mesh Mesh
+  /// @param[in] cell_size Cell size of the grid. If zero, the mean bounding
+  /// box size of faces is used.
+  /// @throw std::invalid_argument If a vertex coordinate divided by the cell
+  /// size is not less than 2^53 in magnitude
+  explicit face_locator(const Mesh& mesh, double cell_size = 0.0)
+      : mesh_{mesh}, cell_size_{cell_size}, lower_cells_(mesh.num_faces()) {
+    FMESH_SCOPED_TIMER("fmesh::face_locator");
+    if (!(cell_size_ > 0.0)) {
+      double sum = 0.0;
+      std::size_t count = 0;
+      for (auto&& fi : mesh.faces()) {
+        if (!mesh.is_valid(fi)) continue;
+        const auto [lower, upper] = bounding_box(fi);
+        const auto d = upper - lower;
+        sum += std::max({d.x, d.y, d.z});
+        ++count;
+      }
+      cell_size_ = count > 0 && sum > 0.0 ? sum / static_cast<double>(count)
+                                          : 1.0;
+    }
+
+    for (auto&& fi : mesh.faces()) {
+      if (!mesh.is_valid(fi)) continue;
+      const auto [lower, upper] = bounding_box(fi);
+      const auto lc = detail::to_grid_cell(lower, cell_size_);
+      const auto uc = detail::to_grid_cell(upper, cell_size_);
+      lower_cells_[fi] = lc;
+      if (grid_.empty()) {
+        min_cell_ = lc;
+        max_cell_ = uc;
+      }
+      min_cell_ = {std::min(min_cell_.i, lc.i), std::min(min_cell_.j, lc.j),
+                   std::min(min_cell_.k, lc.k)};
+      max_cell_ = {std::max(max_cell_.i, uc.i), std::max(max_cell_.j, uc.j),
+                   std::max(max_cell_.k, uc.k)};
+      for (auto i = lc.i; i <= uc.i; ++i)
+        for (auto j = lc.j; j <= uc.j; ++j)
+          for (auto k = lc.k; k <= uc.k; ++k) grid_[{i, j, k}].push_back(fi);
+    }
+  }
+
+  /// @brief Returns the mesh
+  const Mesh& mesh() const noexcept { return mesh_; }
+
+  /// @brief Returns the cell size of the grid
+  double cell_size() const noexcept { return cell_size_; }
+
+  /// @brief Returns the bounding box of a face as its lower and upper corners
+  std::array<vector3, 2> bounding_box(face_index fi) const {
+    const auto& f = mesh_.face(fi);
+    auto lower = to_vector3(mesh_.vertex(f[0]));
+    auto upper = lower;
+    for (auto&& vi : f) {
+      const auto p = to_vector3(mesh_.vertex(vi));
+      lower = {std::min(lower.x, p.x), std::min(lower.y, p.y),
+               std::min(lower.z, p.z)};
+      upper = {std::max(upper.x, p.x), std::max(upper.y, p.y),
+               std::max(upper.z, p.z)};
+    }
+    return {lower, upper};
+  }
+
+  /// @brief Calls a function once for each face whose grid cells overlap a
+  /// box
+  /// @param[in] lower Lower corner of the box
+  /// @param[in] upper Upper corner of the box
+  /// @param[in] f Function called as `f(fi)`
+  ///
+  /// A face is reported in the first common cell of the box and the face, so
+  /// faces spanning several cells are not reported twice.
+  template <typename Function>
+  void for_each_candidate(const vector3& lower, const vector3& upper,
+                          Function&& f) const {
+    const auto lc = detail::to_grid_cell(lower, cell_size_);
+    const auto uc = detail::to_grid_cell(upper, cell_size_);
+    for (auto i = lc.i; i <= uc.i; ++i) {
+      for (auto j = lc.j; j <= uc.j; ++j) {
+        for (auto k = lc.k; k <= uc.k; ++k) {
+          const auto it = grid_.find({i, j, k});
+          if (it == grid_.end()) continue;
+          for (auto&& fi : it->second) {
+            const auto& c = lower_cells_[fi];
+            if (i == std::max(lc.i, c.i) && j == std::max(lc.j, c.j) &&
+                k == std::max(lc.k, c.k))
+              f(fi);
+          }
+        }
+      }
+    }
+  }
+
+  /// @brief Finds the closest point on valid faces
+  /// @param[in] p Query point
+  /// @throw std::invalid_argument If a coordinate divided by the cell size is
+  /// not less than 2^53 in magnitude
+  ///
+  /// Grid cells are searched in rings of increasing distance from the query
+  /// point until no unsearched cell can contain a closer face.
+  location_type closest_point(const vector3& p) const {
+    location_type best;
+    if (grid_.empty()) return best;
+    const auto c = detail::to_grid_cell(p, cell_size_);
+    const auto max_ring = std::max(
+        {std::abs(c.i - min_cell_.i), std::abs(c.i - max_cell_.i),
+         std::abs(c.j - min_cell_.j), std::abs(c.j - max_cell_.j),
+         std::abs(c.k - min_cell_.k), std::abs(c.k - max_cell_.k)});
+
+    const auto visit = [this, &p, &best](const detail::grid_cell& cell) {
+      const auto it = grid_.find(cell);
+      if (it == grid_.end()) return;
+      for (auto&& fi : it->second) {
+        const auto l = locate(fi, p);
+        if (l.distance < best.distance ||
+            (l.distance == best.distance && fi < best.face))
+          best = l;
+      }
+    };
+
+    for (std::int64_t r = 0; r <= max_ring; ++r) {
+      for (auto di = -r; di <= r; ++di) {
+        for (auto dj = -r; dj <= r; ++dj) {
+          const bool is_shell = std::abs(di) == r || std::abs(dj) == r;
+          for (auto dk = -r; dk <= r; dk += is_shell || r == 0 ? 1 : 2 * r)
+            visit({c.i + di, c.j + dj, c.k + dk});
+        }
+      }
+      if (best.distance <= static_cast<double>(r) * cell_size_) break;
+    }
+    return best;
+  }
+
+ private:
+  /// @brief Finds the closest point on a face
+  location_type locate(face_index fi, const vector3& p) const {
+    constexpr auto N = num_face_vertices;
+    const auto& f = mesh_.face(fi);
+    std::array<vector3, N> q;
+    for (std::size_t k = 0; k < N; ++k) q[k] = to_vector3(mesh_.vertex(f[k]));
+
+    // Faces are split into triangles fanning from the first vertex.
+    location_type l;
+    l.face = fi;
+    for (std::size_t k = 1; k + 1 < N; ++k) {
+      const auto w = detail::closest_point_on_triangle(p, q[0], q[k], q[k + 1]);
+      const auto x = w[0] * q[0] + w[1] * q[k] + w[2] * q[k + 1];
+      const auto d = norm(x - p);
+      if (d < l.distance) {
+        l.distance = d;
+        l.weights.fill(0.0);
+        l.weights[0] = w[0];
+        l.weights[k] = w[1];
+        l.weights[k + 1] = w[2];
+      }
+    }
+    return l;
+  }
+
+  const Mesh& mesh_;
+  double cell_size_;
+  std::unordered_map<detail::grid_cell, std::vector<face_index>,
+                     detail::grid_cell_hash>
+      grid_;
+  face_property<detail::grid_cell> lower_cells_;
+  detail::grid_cell min_cell_{};
+  detail::grid_cell max_cell_{};
+};
+
+namespace detail {
+
+/// @brief Returns the area of the overlap of a source face projected onto the
+/// plane of a target face
+template <typename SourceMesh, typename TargetMesh>
+double overlap_area(const SourceMesh& source, face_index si,
+                    const TargetMesh& target, face_index ti,
+                    const transfer_options& options, double tolerance) {
+  const auto& sf = source.face(si);
+  const auto& tf = target.face(ti);
+  const auto sa = area_vector(source, sf);
+  const auto ta = area_vector(target, tf);
+  const auto sn = norm(sa);
+  const auto tn = norm(ta);
+  if (!(sn > 0.0 && tn > 0.0)) return 0.0;
+  const auto normal = ta / tn;
+  if (std::abs(dot(sa / sn, normal)) < options.normal_tolerance) return 0.0;
+
+  const auto origin = to_vector3(target.vertex(tf[0]));
+  for (auto&& vi : sf) {
+    if (std::abs(dot(to_vector3(source.vertex(vi)) - origin, normal)) >
+        tolerance)
+      return 0.0;
+  }
+
+  auto t1 = to_vector3(target.vertex(tf[1])) - origin;
+  t1 = t1 - dot(t1, normal) * normal;
+  t1 = t1 / norm(t1);
+  const auto t2 = cross(normal, t1);
+  const auto project = [&origin, &t1, &t2](const vector3& x) {
+    const auto d = x - origin;
+    return std::array<double, 2>{dot(d, t1), dot(d, t2)};
+  };
+
+  polygon2 clipped;
+  for (auto&& vi : sf)
+    clipped.points[clipped.size++] = project(to_vector3(source.vertex(vi)));
+  constexpr auto N = TargetMesh::face_type::num_vertices;
+  std::array<std::array<double, 2>, N> t;
+  for (std::size_t k = 0; k < N; ++k)
+    t[k] = project(to_vector3(target.vertex(tf[k])));
+  for (std::size_t k = 0; k < N && clipped.size > 0; ++k)
+    clipped = clip(clipped, t[k], t[(k + 1) % N]);
+  return clipped.size > 2 ? std::abs(clipped.area()) : 0.0;
+}
+
+}  // namespace detail
+
+/// @brief Transfers a face property from the mesh of a locator to another
+/// mesh
+/// @param[in] locator Locator of the source mesh
+/// @param[in] values Values on faces of the source mesh
+/// @param[in] target Target mesh
+/// @param[in] method transfer_method::nearest or conservative
+/// @param[in] options Options
+/// @return Values on faces of the target mesh. Invalid faces have T{}.
+/// @throw std::invalid_argument If method is transfer_method::linear
+///
+/// Nearest transfer takes the value of the source face closest to the target
+/// centroid. Conservative transfer averages values of source faces weighted
+/// by their areas overlapping each target face, after projection onto the
+/// plane of the target face; it requires `T + T` and `T * double`. Target
+/// faces without overlapping source faces fall back to nearest transfer.
+/// Target faces are processed in parallel.
+template <typename Locator, typename T, typename Allocator, typename Mesh>
+face_property<T, Allocator> transfer(
+    const Locator& locator, const face_property<T, Allocator>& values,
+    const Mesh& target, transfer_method method,
+    const transfer_options& options = {}) {
+  FMESH_SCOPED_TIMER("fmesh::transfer(face)");
+  if (method == transfer_method::linear) {
+    throw std::invalid_argument{
+        "fmesh::transfer: linear transfer applies to vertex properties"};
+  }
+  const auto& source = locator.mesh();
+  const auto tolerance = options.distance_tolerance > 0.0
+                             ? options.distance_tolerance
+                             : 0.25 * locator.cell_size();
+
+  face_property<T, Allocator> result(target.num_faces());
+  parallel_for_valid(target, target.faces(), [&](face_index ti) {
+    const auto& tf = target.face(ti);
+    if (method == transfer_method::conservative) {
+      auto lower = to_vector3(target.vertex(tf[0]));
+      auto upper = lower;
+      for (auto&& vi : tf) {
+        const auto p = to_vector3(target.vertex(vi));
+        lower = {std::min(lower.x, p.x), std::min(lower.y, p.y),
+                 std::min(lower.z, p.z)};
+        upper = {std::max(upper.x, p.x), std::max(upper.y, p.y),
+                 std::max(upper.z, p.z)};
+      }
+      const vector3 margin{tolerance, tolerance, tolerance};
+
+      T sum{};
+      double area = 0.0;
+      locator.for_each_candidate(
+          lower - margin, upper + margin, [&](face_index si) {
+            const auto a = detail::overlap_area(source, si, target, ti,
+                                                options, tolerance);
+            if (a > 0.0) {
+              sum = sum + values[si] * a;
+              area += a;
+            }
+          });
+      if (area > 0.0) {
+        result[ti] = sum * (1.0 / area);
+        return;
+      }
+    }
+    const auto l = locator.closest_point(centroid(target, tf));
+    if (l.face.is_valid()) result[ti] = values[l.face];
+  });
+  return result;
+}
+
+/// @brief Transfers a vertex property from the mesh of a locator to another
+/// mesh
+/// @param[in] locator Locator of the source mesh
+/// @param[in] values Values on vertices of the source mesh
+/// @param[in] target Target mesh
+/// @param[in] method transfer_method::nearest or linear
+/// @return Values on vertices of the target mesh. Invalid vertices have T{}.
+/// @throw std::invalid_argument If method is transfer_method::conservative
+///
+/// Both methods find the closest point on the source mesh to each target
+/// vertex. Nearest transfer takes the value of the closest vertex of the
+/// face containing the point, and linear transfer interpolates values of the
+/// vertices of the face with barycentric weights; it requires `T + T` and
+/// `T * double`. Target vertices are processed in parallel.
+template <typename Locator, typename T, typename Allocator, typename Mesh>
+vertex_property<T, Allocator> transfer(
+    const Locator& locator, const vertex_property<T, Allocator>& values,
+    const Mesh& target, transfer_method method) {
+  FMESH_SCOPED_TIMER("fmesh::transfer(vertex)");
+  if (method == transfer_method::conservative) {
+    throw std::invalid_argument{
+        "fmesh::transfer: conservative transfer applies to face properties"};
+  }
+  const auto& source = locator.mesh();
+
+  vertex_property<T, Allocator> result(target.num_vertices());
+  parallel_for_valid(target, target.vertices(), [&](vertex_index vi) {
+    const auto l = locator.closest_point(to_vector3(target.vertex(vi)));
+    if (!l.face.is_valid()) return;
+    const auto& f = source.face(l.face);
+    if (method == transfer_method::nearest) {
+      const auto k = std::max_element(l.weights.begin(), l.weights.end()) -
+                     l.weights.begin();
+      result[vi] = values[f[static_cast<std::size_t>(k)]];
+    } else {
+      T sum{};
+      for (std::size_t k = 0; k < f.size(); ++k)
+        sum = sum + values[f[k]] * l.weights[k];
+      result[vi] = sum;
+    }
+  });
+  return result;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_TRANSFER_HPP
@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_UNION_FIND_HPP
+#define FMESH_UNION_FIND_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace fmesh {
+
+namespace detail {
+
+/// @brief Union-find forest which can be united from several threads
+///
+/// Every parent has a smaller index than its child and roots are linked by
+/// compare-and-swap, so the forest stays acyclic and its roots are the
+/// smallest indices of their sets regardless of the order of unions.
+///
+/// Elements must be set by reset() before they are united. Values other
+/// than the index itself or a smaller index can be stored to mark elements
+/// which are never united.
+class atomic_union_find {
+ public:
+  atomic_union_find() = default;
+
+  explicit atomic_union_find(std::size_t n) : parents_(n) {}
+
+  std::size_t size() const noexcept { return parents_.size(); }
+
+  void clear() noexcept { parents_.clear(); }
+
+  /// @brief Resizes the forest, keeping the existing parents
+  ///
+  /// New elements must be set by reset().
+  void resize(std::size_t n) {
+    if (n == parents_.size()) return;
+    std::vector<std::atomic<std::size_t>> parents(n);
+    const auto m = std::min(n, parents_.size());
+    for (std::size_t i = 0; i < m; ++i)
+      parents[i].store(this->parent(i), std::memory_order_relaxed);
+    parents_.swap(parents);
+  }
+
+  /// @brief Sets the parent of an element
+  ///
+  /// It must not race with unions involving the element.
+  void reset(std::size_t i, std::size_t parent) noexcept {
+    parents_[i].store(parent, std::memory_order_relaxed);
+  }
+
+  std::size_t parent(std::size_t i) const noexcept {
+    return parents_[i].load(std::memory_order_relaxed);
+  }
+
+  /// @brief Finds the root with path halving
+  ///
+  /// A concurrent unite() may link the root found here, which unite()
+  /// handles by retrying.
+  std::size_t find(std::size_t i) noexcept {
+    auto p = this->parent(i);
+    while (p != i) {
+      const auto gp = this->parent(p);
+      // Shortcuts only move towards smaller indices, so a failed exchange
+      // just means another thread has already gone further.
+      if (gp != p)
+        parents_[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+      i = gp;
+      p = this->parent(i);
+    }
+    return i;
+  }
+
+  /// @brief Unites two trees under the smaller root
+  void unite(std::size_t i, std::size_t j) noexcept {
+    for (;;) {
+      i = this->find(i);
+      j = this->find(j);
+      if (i == j) return;
+      if (i > j) std::swap(i, j);
+      // Links j only if it is still a root.
+      auto expected = j;
+      if (parents_[j].compare_exchange_strong(expected, i,
+                                              std::memory_order_relaxed))
+        return;
+    }
+  }
+
+ private:
+  std::vector<std::atomic<std::size_t>> parents_;
+};
+
+}  // namespace detail
+
+}  // namespace fmesh
+
+#endif  // FMESH_UNION_FIND_HPP
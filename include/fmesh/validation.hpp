@@ -0,0 +1,434 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_VALIDATION_HPP
+#define FMESH_VALIDATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+
+namespace fmesh {
+
+/// @brief Kind of mesh entities
+enum class entity_kind : std::uint8_t { vertex, edge, face };
+
+/// @brief Kind of inconsistencies found by validate()
+enum class issue_kind : std::uint8_t {
+  /// An index out of range
+  dangling_index,
+  /// A relation without its counterpart, e.g. an edge in vertex-edges of a
+  /// vertex which is not an end of the edge
+  asymmetric_adjacency,
+  /// A valid entity refers to an invalid entity
+  invalid_reference,
+  /// Valid edges or faces consisting of the same vertices
+  duplicate_entity,
+  /// An edge or a face with repeated vertices
+  degenerate_entity,
+  /// A valid vertex or edge without any valid faces
+  isolated_entity,
+  /// Faces around a vertex are not connected through edges of the vertex,
+  /// e.g. two sheets touching at a single vertex. Branching edges are not
+  /// reported.
+  non_manifold_vertex,
+};
+
+/// @brief An inconsistency of a mesh entity
+struct mesh_issue {
+  /// Index used if there is no related entity
+  static constexpr auto no_index = std::numeric_limits<std::size_t>::max();
+
+  issue_kind kind;
+  /// The entity which has the issue
+  entity_kind entity;
+  std::size_t index;
+  /// The entity causing the issue, if any
+  entity_kind related_entity = entity_kind::vertex;
+  std::size_t related_index = no_index;
+};
+
+inline const char* to_string(entity_kind kind) noexcept {
+  switch (kind) {
+    case entity_kind::vertex:
+      return "vertex";
+    case entity_kind::edge:
+      return "edge";
+    case entity_kind::face:
+      return "face";
+  }
+  return "";
+}
+
+inline const char* to_string(issue_kind kind) noexcept {
+  switch (kind) {
+    case issue_kind::dangling_index:
+      return "dangling_index";
+    case issue_kind::asymmetric_adjacency:
+      return "asymmetric_adjacency";
+    case issue_kind::invalid_reference:
+      return "invalid_reference";
+    case issue_kind::duplicate_entity:
+      return "duplicate_entity";
+    case issue_kind::degenerate_entity:
+      return "degenerate_entity";
+    case issue_kind::isolated_entity:
+      return "isolated_entity";
+    case issue_kind::non_manifold_vertex:
+      return "non_manifold_vertex";
+  }
+  return "";
+}
+
+inline std::ostream& operator<<(std::ostream& os, const mesh_issue& issue) {
+  os << to_string(issue.kind) << ' ' << to_string(issue.entity) << ' '
+     << issue.index;
+  if (issue.related_index != mesh_issue::no_index) {
+    os << " (" << to_string(issue.related_entity) << ' '
+       << issue.related_index << ')';
+  }
+  return os;
+}
+
+namespace detail {
+
+template <typename Range, typename T>
+bool contains(const Range& r, const T& value) {
+  return std::find(r.begin(), r.end(), value) != r.end();
+}
+
+/// @brief Work arrays to check faces around a vertex
+struct vertex_check_workspace {
+  std::vector<face_index> faces;
+  std::vector<std::size_t> parents;
+
+  std::size_t find_root(std::size_t i) {
+    while (parents[i] != i) i = parents[i] = parents[parents[i]];
+    return i;
+  }
+};
+
+template <typename Mesh>
+void validate_vertex(const Mesh& mesh, vertex_index vi,
+                     vertex_check_workspace& work,
+                     std::vector<mesh_issue>& issues) {
+  const auto report = [&issues, vi](issue_kind kind, entity_kind related,
+                                    std::size_t j) {
+    issues.push_back(
+        {kind, entity_kind::vertex, static_cast<std::size_t>(vi), related, j});
+  };
+
+  const auto es = mesh.vertex_edges(vi);
+  const auto vs = mesh.vertex_vertices(vi);
+  if (es.size() != vs.size()) {
+    report(issue_kind::asymmetric_adjacency, entity_kind::vertex,
+           mesh_issue::no_index);
+  }
+  for (std::size_t k = 0; k < es.size(); ++k) {
+    const auto ei = es.begin()[k];
+    if (static_cast<std::size_t>(ei) >= mesh.num_edges()) {
+      report(issue_kind::dangling_index, entity_kind::edge,
+             static_cast<std::size_t>(ei));
+      continue;
+    }
+    const auto& e = mesh.edge(ei);
+    if (!e.contains(vi)) {
+      report(issue_kind::asymmetric_adjacency, entity_kind::edge,
+             static_cast<std::size_t>(ei));
+    } else if (k < vs.size()) {
+      const auto vj = vs.begin()[k];
+      if (vj != (e.first == vi ? e.second : e.first)) {
+        report(issue_kind::asymmetric_adjacency, entity_kind::vertex,
+               static_cast<std::size_t>(vj));
+      }
+    }
+  }
+
+  work.faces.clear();
+  for (auto&& fi : mesh.vertex_faces(vi)) {
+    if (static_cast<std::size_t>(fi) >= mesh.num_faces()) {
+      report(issue_kind::dangling_index, entity_kind::face,
+             static_cast<std::size_t>(fi));
+    } else if (!mesh.face(fi).contains(vi)) {
+      report(issue_kind::asymmetric_adjacency, entity_kind::face,
+             static_cast<std::size_t>(fi));
+    } else if (mesh.is_valid(fi)) {
+      work.faces.push_back(fi);
+    }
+  }
+
+  if (!mesh.is_valid(vi)) return;
+  if (work.faces.empty()) {
+    report(issue_kind::isolated_entity, entity_kind::vertex,
+           mesh_issue::no_index);
+    return;
+  }
+
+  // Faces sharing a valid edge of the vertex are connected. All faces at a
+  // branching edge are connected as well.
+  const auto nf = work.faces.size();
+  work.parents.resize(nf);
+  for (std::size_t i = 0; i < nf; ++i) work.parents[i] = i;
+  for (auto&& ei : es) {
+    if (static_cast<std::size_t>(ei) >= mesh.num_edges() ||
+        !mesh.is_valid(ei) || !mesh.edge(ei).contains(vi))
+      continue;
+    auto first = nf;
+    for (auto&& fi : mesh.edge_faces(ei)) {
+      const auto it = std::find(work.faces.begin(), work.faces.end(), fi);
+      if (it == work.faces.end()) continue;
+      const auto i = static_cast<std::size_t>(it - work.faces.begin());
+      if (first == nf) {
+        first = i;
+      } else {
+        work.parents[work.find_root(i)] = work.find_root(first);
+      }
+    }
+  }
+  const auto root = work.find_root(0);
+  for (std::size_t i = 1; i < nf; ++i) {
+    if (work.find_root(i) != root) {
+      report(issue_kind::non_manifold_vertex, entity_kind::face,
+             static_cast<std::size_t>(work.faces[i]));
+      break;
+    }
+  }
+}
+
+template <typename Mesh>
+void validate_edge(const Mesh& mesh, edge_index ei,
+                   std::vector<mesh_issue>& issues) {
+  const auto report = [&issues, ei](issue_kind kind, entity_kind related,
+                                    std::size_t j) {
+    issues.push_back(
+        {kind, entity_kind::edge, static_cast<std::size_t>(ei), related, j});
+  };
+
+  const auto& e = mesh.edge(ei);
+  bool has_dangling_vertex = false;
+  for (auto&& vi : {e.first, e.second}) {
+    if (static_cast<std::size_t>(vi) >= mesh.num_vertices()) {
+      report(issue_kind::dangling_index, entity_kind::vertex,
+             static_cast<std::size_t>(vi));
+      has_dangling_vertex = true;
+    } else if (!contains(mesh.vertex_edges(vi), ei)) {
+      report(issue_kind::asymmetric_adjacency, entity_kind::vertex,
+             static_cast<std::size_t>(vi));
+    }
+  }
+  if (e.first == e.second) {
+    report(issue_kind::degenerate_entity, entity_kind::vertex,
+           static_cast<std::size_t>(e.first));
+  }
+
+  bool has_valid_face = false;
+  for (auto&& fi : mesh.edge_faces(ei)) {
+    if (static_cast<std::size_t>(fi) >= mesh.num_faces()) {
+      report(issue_kind::dangling_index, entity_kind::face,
+             static_cast<std::size_t>(fi));
+    } else if (!contains(mesh.face_edges(fi), ei)) {
+      report(issue_kind::asymmetric_adjacency, entity_kind::face,
+             static_cast<std::size_t>(fi));
+    } else if (mesh.is_valid(fi)) {
+      has_valid_face = true;
+    }
+  }
+
+  if (!mesh.is_valid(ei) || has_dangling_vertex) return;
+  for (auto&& vi : {e.first, e.second}) {
+    if (!mesh.is_valid(vi)) {
+      report(issue_kind::invalid_reference, entity_kind::vertex,
+             static_cast<std::size_t>(vi));
+    }
+  }
+  if (!has_valid_face) {
+    report(issue_kind::isolated_entity, entity_kind::edge,
+           mesh_issue::no_index);
+  }
+  // Reports a duplicate on the larger index only.
+  for (auto&& ej : mesh.vertex_edges(e.first)) {
+    if (ej < ei && static_cast<std::size_t>(ej) < mesh.num_edges() &&
+        mesh.is_valid(ej) && mesh.edge(ej) == e) {
+      report(issue_kind::duplicate_entity, entity_kind::edge,
+             static_cast<std::size_t>(ej));
+    }
+  }
+}
+
+template <typename Mesh>
+void validate_face(const Mesh& mesh, face_index fi,
+                   std::vector<mesh_issue>& issues) {
+  using face_type = typename Mesh::face_type;
+  constexpr auto N = face_type::num_vertices;
+
+  const auto report = [&issues, fi](issue_kind kind, entity_kind related,
+                                    std::size_t j) {
+    issues.push_back(
+        {kind, entity_kind::face, static_cast<std::size_t>(fi), related, j});
+  };
+
+  const auto& f = mesh.face(fi);
+  std::array<vertex_index, N> sorted;
+  std::copy(f.begin(), f.end(), sorted.begin());
+  std::sort(sorted.begin(), sorted.end());
+  if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+    report(issue_kind::degenerate_entity, entity_kind::vertex,
+           mesh_issue::no_index);
+  }
+
+  bool has_dangling_index = false;
+  for (auto&& vi : f) {
+    if (static_cast<std::size_t>(vi) >= mesh.num_vertices()) {
+      report(issue_kind::dangling_index, entity_kind::vertex,
+             static_cast<std::size_t>(vi));
+      has_dangling_index = true;
+    } else if (!contains(mesh.vertex_faces(vi), fi)) {
+      report(issue_kind::asymmetric_adjacency, entity_kind::vertex,
+             static_cast<std::size_t>(vi));
+    }
+  }
+
+  const auto es = mesh.face_edges(fi);
+  const auto fedges = f.to_edges();
+  if (es.size() != fedges.size()) {
+    report(issue_kind::asymmetric_adjacency, entity_kind::edge,
+           mesh_issue::no_index);
+  }
+  for (std::size_t k = 0; k < es.size(); ++k) {
+    const auto ei = es.begin()[k];
+    if (static_cast<std::size_t>(ei) >= mesh.num_edges()) {
+      report(issue_kind::dangling_index, entity_kind::edge,
+             static_cast<std::size_t>(ei));
+      has_dangling_index = true;
+    } else if ((k < fedges.size() && mesh.edge(ei) != fedges[k]) ||
+               !contains(mesh.edge_faces(ei), fi)) {
+      report(issue_kind::asymmetric_adjacency, entity_kind::edge,
+             static_cast<std::size_t>(ei));
+    }
+  }
+
+  if (!mesh.is_valid(fi) || has_dangling_index) return;
+  for (auto&& vi : f) {
+    if (!mesh.is_valid(vi)) {
+      report(issue_kind::invalid_reference, entity_kind::vertex,
+             static_cast<std::size_t>(vi));
+    }
+  }
+  for (auto&& ei : es) {
+    if (!mesh.is_valid(ei)) {
+      report(issue_kind::invalid_reference, entity_kind::edge,
+             static_cast<std::size_t>(ei));
+    }
+  }
+  // Reports a duplicate on the larger index only.
+  if (es.size() == 0) return;
+  for (auto&& fj : mesh.edge_faces(*es.begin())) {
+    if (fj >= fi || static_cast<std::size_t>(fj) >= mesh.num_faces() ||
+        !mesh.is_valid(fj))
+      continue;
+    const auto& g = mesh.face(fj);
+    std::array<vertex_index, N> other;
+    std::copy(g.begin(), g.end(), other.begin());
+    std::sort(other.begin(), other.end());
+    if (other == sorted) {
+      report(issue_kind::duplicate_entity, entity_kind::face,
+             static_cast<std::size_t>(fj));
+    }
+  }
+}
+
+/// @brief Runs `check(first, last, issues)` over chunks of [0, n) in parallel
+///
+/// Issues of each chunk are collected separately and appended in the order
+/// of chunks, so they stay sorted by index.
+template <typename Check>
+void validate_chunks(std::size_t n, std::vector<mesh_issue>& issues,
+                     Check&& check, std::size_t grain = 1024) {
+  const auto num_chunks = (n + grain - 1) / grain;
+  std::vector<std::vector<mesh_issue>> found(num_chunks);
+  std::vector<std::size_t> chunks(num_chunks);
+  std::iota(chunks.begin(), chunks.end(), std::size_t{0});
+  parallel_for(
+      chunks,
+      [&](std::size_t c) {
+        check(c * grain, std::min(n, (c + 1) * grain), found[c]);
+      },
+      1);
+  for (auto&& f : found) issues.insert(issues.end(), f.begin(), f.end());
+}
+
+}  // namespace detail
+
+/// @brief Cross-checks connectivity data and validity flags of a mesh
+/// @param[in] mesh Mesh
+/// @return Issues sorted by entity kind and index. A consistent mesh returns
+/// an empty list.
+///
+/// Every vertex, edge, and face is checked independently against its
+/// neighbors, so the cost is linear in the mesh size and the sum of squared
+/// valences. Invalid entities are checked only for symmetry of their
+/// relations.
+///
+/// Entities are checked in parallel chunks after caches of the mesh are
+/// built.
+template <typename Mesh>
+std::vector<mesh_issue> validate(const Mesh& mesh) {
+  FMESH_SCOPED_TIMER("fmesh::validate");
+  mesh.build_caches();
+  std::vector<mesh_issue> issues;
+  detail::validate_chunks(
+      mesh.num_vertices(), issues,
+      [&mesh](std::size_t first, std::size_t last,
+              std::vector<mesh_issue>& found) {
+        detail::vertex_check_workspace work;
+        for (auto i = first; i < last; ++i)
+          detail::validate_vertex(mesh, vertex_index{i}, work, found);
+      });
+  detail::validate_chunks(
+      mesh.num_edges(), issues,
+      [&mesh](std::size_t first, std::size_t last,
+              std::vector<mesh_issue>& found) {
+        for (auto i = first; i < last; ++i)
+          detail::validate_edge(mesh, edge_index{i}, found);
+      });
+  detail::validate_chunks(
+      mesh.num_faces(), issues,
+      [&mesh](std::size_t first, std::size_t last,
+              std::vector<mesh_issue>& found) {
+        for (auto i = first; i < last; ++i)
+          detail::validate_face(mesh, face_index{i}, found);
+      });
+  return issues;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_VALIDATION_HPP
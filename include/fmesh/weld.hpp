@@ -0,0 +1,249 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_WELD_HPP
+#define FMESH_WELD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/geometry.hpp"
+#include "fmesh/index.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "fmesh/property_array.hpp"
+#include "fmesh/union_find.hpp"
+
+namespace fmesh {
+
+/// @brief Result of weld_vertices()
+struct weld_result {
+  /// The number of vertices merged into other vertices
+  std::size_t num_merged_vertices = 0;
+  /// The number of faces removed because they collapsed or coincided with
+  /// other faces
+  std::size_t num_removed_faces = 0;
+  /// Maps from indices before welding to indices after welding. Merged
+  /// vertices are mapped to the vertices they are merged into, and removed
+  /// edges and faces to coinciding ones if any.
+  entity_remap remap;
+};
+
+namespace detail {
+
+/// @brief Finds the smallest vertex index of each cluster of coincident
+/// vertices
+/// @return The representative of each valid vertex, and an invalid index for
+/// invalid vertices
+///
+/// Cells of vertices are computed in parallel. Vertices are sorted by cell
+/// on the calling thread, so each cell is a contiguous range of the sorted
+/// vertices, and then united with close vertices of adjacent cells in
+/// parallel.
+template <typename Mesh>
+vertex_property<vertex_index> cluster_vertices(const Mesh& mesh,
+                                               double tolerance) {
+  const auto nv = mesh.num_vertices();
+  std::vector<grid_cell> cells(nv);
+  atomic_union_find forest{nv};
+  parallel_for_valid(mesh, mesh.vertices(), [&](vertex_index vi) {
+    cells[vi.get()] = to_grid_cell(to_vector3(mesh.vertex(vi)), tolerance);
+    forest.reset(vi.get(), vi.get());
+  });
+
+  // Sorted by cell and then by index
+  std::vector<std::size_t> order;
+  order.reserve(nv);
+  for (auto&& vi : mesh.vertices()) {
+    if (mesh.is_valid(vi)) order.push_back(vi.get());
+  }
+  std::sort(order.begin(), order.end(),
+            [&cells](std::size_t i, std::size_t j) {
+              return cells[i] < cells[j] || (cells[i] == cells[j] && i < j);
+            });
+  std::vector<grid_cell> sorted_cells(order.size());
+  for (std::size_t k = 0; k < order.size(); ++k)
+    sorted_cells[k] = cells[order[k]];
+
+  // Cells are as large as the tolerance, so coincident vertices are in
+  // adjacent cells.
+  parallel_for(order, [&](std::size_t i) {
+    const auto p = to_vector3(mesh.vertex(vertex_index{i}));
+    const auto& c = cells[i];
+    for (std::int64_t di = -1; di <= 1; ++di) {
+      for (std::int64_t dj = -1; dj <= 1; ++dj) {
+        for (std::int64_t dk = -1; dk <= 1; ++dk) {
+          const auto [first, last] =
+              std::equal_range(sorted_cells.begin(), sorted_cells.end(),
+                               grid_cell{c.i + di, c.j + dj, c.k + dk});
+          for (auto it = first; it != last; ++it) {
+            const auto j = order[static_cast<std::size_t>(
+                it - sorted_cells.begin())];
+            const auto q = to_vector3(mesh.vertex(vertex_index{j}));
+            if (j > i && norm(q - p) <= tolerance) forest.unite(i, j);
+          }
+        }
+      }
+    }
+  });
+
+  vertex_property<vertex_index> roots(nv);
+  parallel_for_valid(mesh, mesh.vertices(), [&](vertex_index vi) {
+    roots[vi] = vertex_index{forest.find(vi.get())};
+  });
+  return roots;
+}
+
+/// @brief Finds a valid face consisting of the same vertices in any order
+template <typename Mesh>
+face_index find_coincident_face(const Mesh& mesh,
+                                const typename Mesh::face_type& f) {
+  constexpr auto N = Mesh::face_type::num_vertices;
+  const auto sorted_vertices = [](const auto& g) {
+    std::array<vertex_index, N> vs;
+    std::copy(g.begin(), g.end(), vs.begin());
+    std::sort(vs.begin(), vs.end());
+    return vs;
+  };
+  const auto vs = sorted_vertices(f);
+  for (auto&& fi : mesh.vertex_faces(f[0])) {
+    if (mesh.is_valid(fi) && sorted_vertices(mesh.face(fi)) == vs) return fi;
+  }
+  return face_index{};
+}
+
+}  // namespace detail
+
+/// @brief Merges coincident vertices and the edges and faces they share
+/// @param[in,out] mesh Mesh
+/// @param[in] tolerance Vertices closer than this distance are merged
+/// @return Maps from old to new indices and statistics
+/// @throw std::invalid_argument If the tolerance is not positive, or if a
+/// coordinate divided by the tolerance is not less than 2^53 in magnitude.
+/// The mesh is not modified in either case.
+///
+/// This function joins meshes of independent fracture surfaces along their
+/// intersections, so that faces share edges and branches are detected.
+/// Vertices are clustered in parallel on a uniform grid with cells as large
+/// as the tolerance, and clusters are closed transitively. Each cluster is
+/// merged into its vertex with the smallest index, which keeps its position.
+/// Merged faces are replaced on the calling thread, since each replacement
+/// updates adjacency shared with neighboring faces.
+///
+/// Faces with merged vertices are replaced by new faces. Faces whose vertices
+/// collapse, or which coincide with other faces in any orientation, are
+/// removed. Invalid entities are removed from the mesh at the end.
+template <typename Mesh>
+weld_result weld_vertices(Mesh& mesh, double tolerance) {
+  FMESH_SCOPED_TIMER("fmesh::weld_vertices");
+  if (!(tolerance > 0.0)) {
+    throw std::invalid_argument{
+        "fmesh::weld_vertices: tolerance must be positive"};
+  }
+
+  weld_result result;
+  const auto roots = detail::cluster_vertices(mesh, tolerance);
+  const auto nv = mesh.num_vertices();
+  const auto ne = mesh.num_edges();
+  const auto nf = mesh.num_faces();
+
+  edge_property<bool> was_valid_edge(ne);
+  for (auto&& ei : mesh.edges()) was_valid_edge[ei] = mesh.is_valid(ei);
+
+  // Replaces faces with merged vertices. New faces are added before old faces
+  // are invalidated, so that merged-into vertices are never left isolated.
+  // New faces stay in the fracture of the replaced faces.
+  const auto current = mesh.current_fracture();
+  face_property<face_index> faces(nf);
+  for (face_index fi{0}; fi < face_index{nf}; ++fi) {
+    if (!mesh.is_valid(fi)) continue;
+    auto f = mesh.face(fi);
+    bool is_merged = false;
+    for (auto&& vi : f) {
+      if (roots[vi] != vi) {
+        vi = roots[vi];
+        is_merged = true;
+      }
+    }
+    if (!is_merged) {
+      faces[fi] = fi;
+      continue;
+    }
+
+    auto vs = std::vector<vertex_index>(f.begin(), f.end());
+    std::sort(vs.begin(), vs.end());
+    if (std::adjacent_find(vs.begin(), vs.end()) != vs.end()) {
+      ++result.num_removed_faces;
+    } else if (const auto fj = detail::find_coincident_face(mesh, f);
+               fj.is_valid()) {
+      faces[fi] = fj;
+      ++result.num_removed_faces;
+    } else {
+      mesh.set_current_fracture(mesh.face_fracture(fi));
+      faces[fi] = mesh.add_face(f);
+    }
+    mesh.invalidate(fi);
+  }
+  mesh.set_current_fracture(current);
+
+  // Vertices without faces are not invalidated by invalidate(face_index).
+  for (vertex_index vi{0}; vi < vertex_index{nv}; ++vi) {
+    if (roots[vi].is_valid() && roots[vi] != vi) {
+      ++result.num_merged_vertices;
+      if (mesh.is_valid(vi)) mesh.invalidate(vi);
+    }
+  }
+
+  edge_property<edge_index> edges(ne);
+  for (edge_index ei{0}; ei < edge_index{ne}; ++ei) {
+    if (!was_valid_edge[ei]) continue;
+    const auto& e = mesh.edge(ei);
+    const auto ej = mesh.find(typename Mesh::edge_type{roots[e.first],
+                                                       roots[e.second]});
+    if (ej.is_valid() && mesh.is_valid(ej)) edges[ei] = ej;
+  }
+
+  const auto compaction = mesh.remove_invalid_entities();
+  auto& remap = result.remap;
+  remap.vertices.resize(nv);
+  for (vertex_index vi{0}; vi < vertex_index{nv}; ++vi) {
+    if (roots[vi].is_valid()) remap.vertices[vi] = compaction.vertices[roots[vi]];
+  }
+  remap.edges.resize(ne);
+  for (edge_index ei{0}; ei < edge_index{ne}; ++ei) {
+    if (edges[ei].is_valid()) remap.edges[ei] = compaction.edges[edges[ei]];
+  }
+  remap.faces.resize(nf);
+  for (face_index fi{0}; fi < face_index{nf}; ++fi) {
+    if (faces[fi].is_valid()) remap.faces[fi] = compaction.faces[faces[fi]];
+  }
+  return result;
+}
+
+}  // namespace fmesh
+
+#endif  // FMESH_WELD_HPP
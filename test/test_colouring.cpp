@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "fmesh/colouring.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+namespace {
+
+fracture_mesh<point, tri_face> make_mesh(int n) {
+  auto mesh = make_grid<fracture_mesh<point, tri_face>>(n);
+  // A branch along a diagonal
+  const auto a = mesh.add_vertex(0.0, 0.0, 1.0);
+  mesh.add_face(vertex_index{0}, vertex_index{static_cast<std::size_t>(n + 2)},
+                a);
+  mesh.invalidate(face_index{3});
+  return mesh;
+}
+
+template <typename Index, typename Conflicts>
+void check_colouring(const colouring<Index>& c, std::size_t num_valid,
+                     Conflicts&& conflicts) {
+  ASSERT_EQ(c.colour_offsets.size(), c.num_colours() + 1);
+  EXPECT_EQ(c.indices.size(), num_valid);
+  for (std::size_t k = 0; k < c.num_colours(); ++k) {
+    const auto r = c.colour(k);
+    EXPECT_TRUE(std::is_sorted(r.begin(), r.end()));
+    for (auto i = r.begin(); i != r.end(); ++i)
+      for (auto j = i + 1; j != r.end(); ++j) EXPECT_FALSE(conflicts(*i, *j));
+  }
+}
+
+}  // namespace
+
+TEST(ColouringTest, Faces) {
+  const auto mesh = make_mesh(4);
+  const auto num_valid = mesh.num_faces() - 1;
+
+  for (auto method :
+       {colouring_method::greedy, colouring_method::jones_plassmann}) {
+    const auto by_vertex = colour_faces(mesh, face_conflict::vertex, method);
+    check_colouring(by_vertex, num_valid, [&mesh](auto fi, auto fj) {
+      return mesh.face(fi).shares_vertex_with(mesh.face(fj));
+    });
+    EXPECT_LE(by_vertex.num_colours(), 13u);
+
+    const auto by_edge = colour_faces(mesh, face_conflict::edge, method);
+    check_colouring(by_edge, num_valid, [&mesh](auto fi, auto fj) {
+      return mesh.face(fi).shares_edge_with(mesh.face(fj));
+    });
+    // A branching edge is shared by three faces.
+    EXPECT_GE(by_edge.num_colours(), 3u);
+    EXPECT_LT(by_edge.num_colours(), by_vertex.num_colours());
+  }
+}
+
+TEST(ColouringTest, Edges) {
+  const auto mesh = make_mesh(3);
+  std::size_t num_valid = 0;
+  for (auto&& ei : mesh.edges()) num_valid += mesh.is_valid(ei);
+
+  for (auto method :
+       {colouring_method::greedy, colouring_method::jones_plassmann}) {
+    const auto c = colour_edges(mesh, method);
+    check_colouring(c, num_valid, [&mesh](auto ei, auto ej) {
+      return mesh.edge(ei).shares_vertex_with(mesh.edge(ej));
+    });
+  }
+}
+
+TEST(ColouringTest, JonesPlassmannInParallelChunks) {
+  // Rounds span several chunks of 1024 faces.
+  const auto mesh = make_mesh(40);
+  const auto c = colour_faces(mesh, face_conflict::vertex,
+                              colouring_method::jones_plassmann);
+  check_colouring(c, mesh.num_faces() - 1, [&mesh](auto fi, auto fj) {
+    return mesh.face(fi).shares_vertex_with(mesh.face(fj));
+  });
+
+  for (int n = 0; n < 4; ++n) {
+    const auto d = colour_faces(mesh, face_conflict::vertex,
+                                colouring_method::jones_plassmann);
+    EXPECT_EQ(d.colour_offsets, c.colour_offsets);
+    EXPECT_EQ(d.indices, c.indices);
+  }
+}
+
+TEST(ColouringTest, ParallelScatterAdd) {
+  const auto mesh = make_mesh(40);
+  const auto colours = colour_faces(mesh, face_conflict::vertex);
+
+  // Integral contributions are summed exactly in any order.
+  const auto keys = [&mesh](face_index fi) { return mesh.face(fi); };
+  const auto contributions = [](face_index fi) {
+    const auto w = static_cast<double>(fi.get() % 5);
+    return std::vector<double>{w, w + 1.0, w + 2.0};
+  };
+  vertex_property<double> expected(mesh.num_vertices());
+  for (auto&& fi : mesh.faces()) {
+    if (mesh.is_valid(fi)) scatter_add(expected, keys(fi), contributions(fi));
+  }
+
+  vertex_property<double> sums(mesh.num_vertices());
+  scatter_add(sums, colours, keys, contributions, 16);
+  for (auto&& vi : mesh.vertices()) EXPECT_EQ(sums[vi], expected[vi]);
+}
@@ -0,0 +1,168 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <queue>
+#include <vector>
+#include "fmesh/components.hpp"
+#include "fmesh/dfn.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+namespace {
+
+// Breadth-first search numbering components by their smallest face index
+template <typename Mesh, typename Mask>
+std::uint32_t reference_labels(const Mesh& mesh, Mask mask,
+                               std::vector<std::uint32_t>& labels) {
+  labels.assign(mesh.num_faces(), face_components::invalid_component);
+  std::vector<bool> visited(mesh.num_faces(), false);
+  std::uint32_t n = 0;
+  for (std::size_t i = 0; i < mesh.num_faces(); ++i) {
+    const face_index fi{i};
+    if (visited[i] || !mesh.is_valid(fi) || !mask(fi)) continue;
+    std::queue<face_index> queue;
+    queue.push(fi);
+    visited[i] = true;
+    while (!queue.empty()) {
+      const auto f = queue.front();
+      queue.pop();
+      labels[f.get()] = n;
+      for (auto&& ei : mesh.face_edges(f)) {
+        for (auto&& fj : mesh.edge_faces(ei)) {
+          if (visited[fj.get()] || !mesh.is_valid(fj) || !mask(fj)) continue;
+          visited[fj.get()] = true;
+          queue.push(fj);
+        }
+      }
+    }
+    ++n;
+  }
+  return n;
+}
+
+}  // namespace
+
+TEST(ComponentsTest, IncrementalLabelling) {
+  fracture_mesh<point, tri_face> mesh;
+
+  std::vector<vertex_index> v;
+  for (int i = 0; i < 8; ++i) v.push_back(mesh.add_vertex(i, 0.0, i % 2));
+
+  // Two separate fractures, one with a branch
+  mesh.add_face(v[0], v[1], v[2]);
+  mesh.add_face(v[1], v[3], v[2]);
+  mesh.add_face(v[1], v[4], v[2]);
+  mesh.add_face(v[5], v[6], v[7]);
+
+  face_components components;
+  face_property<std::uint32_t> labels;
+  EXPECT_EQ(components.label(mesh, labels), 2);
+  EXPECT_EQ(labels[face_index{0}], 0);
+  EXPECT_EQ(labels[face_index{2}], 0);
+  EXPECT_EQ(labels[face_index{3}], 1);
+
+  // Ignore the face connecting the branch
+  const auto open = [](face_index fi) { return fi != face_index{0}; };
+  EXPECT_EQ(components.label(mesh, labels, open), 2);
+  EXPECT_EQ(labels[face_index{0}], face_components::invalid_component);
+  EXPECT_EQ(labels[face_index{1}], 0);
+
+  // A new face connecting both fractures
+  mesh.add_face(v[4], v[5], v[6]);
+  mesh.add_face(v[2], v[4], v[6]);
+  EXPECT_EQ(components.update(mesh, labels, open), 1);
+  for (std::size_t i = 1; i < mesh.num_faces(); ++i)
+    EXPECT_EQ(labels[face_index{i}], 0);
+}
+
+TEST(ComponentsTest, ParallelMatchesSerial) {
+  fracture_mesh<point, tri_face> dfn;
+  dfn_parameters param;
+  param.seed = 11;
+  param.num_fractures = 48;
+  param.num_cells = 32;
+  generate_dfn(dfn, param);
+  ASSERT_GT(dfn.num_faces(), 1000);
+
+  // Rebuild the network in two batches to exercise update()
+  fracture_mesh<point, tri_face> mesh;
+  for (auto&& vi : dfn.vertices()) {
+    const auto& p = dfn.vertex(vi);
+    mesh.add_vertex(p.x, p.y, p.z);
+  }
+  const auto half = dfn.num_faces() / 2;
+  const auto add_faces = [&](std::size_t first, std::size_t last) {
+    for (auto i = first; i < last; ++i) mesh.add_face(dfn.face(face_index{i}));
+  };
+  const auto open = [](face_index fi) { return fi.get() % 7 != 3; };
+
+  face_components components;
+  face_property<std::uint32_t> labels;
+  std::vector<std::uint32_t> expected;
+  add_faces(0, half);
+  EXPECT_EQ(components.label(mesh, labels, open),
+            reference_labels(mesh, open, expected));
+  for (std::size_t i = 0; i < half; ++i)
+    ASSERT_EQ(labels[face_index{i}], expected[i]);
+
+  add_faces(half, dfn.num_faces());
+  const auto n = components.update(mesh, labels, open);
+  EXPECT_EQ(n, reference_labels(mesh, open, expected));
+  EXPECT_GT(n, 1);
+  for (std::size_t i = 0; i < mesh.num_faces(); ++i)
+    ASSERT_EQ(labels[face_index{i}], expected[i]);
+}
+
+TEST(ComponentsTest, UpdateAfterCompaction) {
+  fracture_mesh<point, tri_face> mesh;
+  std::vector<vertex_index> v;
+  for (int i = 0; i < 7; ++i) v.push_back(mesh.add_vertex(i, 0.0, i % 2));
+  mesh.add_face(v[0], v[1], v[2]);
+  mesh.add_face(v[1], v[3], v[2]);
+  mesh.add_face(v[4], v[5], v[6]);
+
+  face_components components;
+  face_property<std::uint32_t> labels;
+  EXPECT_EQ(components.label(mesh, labels), 2);
+
+  // The mesh shrinks, so the forest is rebuilt.
+  mesh.invalidate(face_index{0});
+  mesh.remove_invalid_entities();
+  ASSERT_EQ(mesh.num_faces(), 2);
+  EXPECT_EQ(components.update(mesh, labels), 2);
+  EXPECT_EQ(labels.size(), 2);
+
+  const auto always = [](face_index) { return true; };
+  std::vector<std::uint32_t> expected;
+  // A strip joining both faces, numbered after compaction
+  mesh.add_face(vertex_index{2}, vertex_index{1}, vertex_index{3});
+  mesh.add_face(vertex_index{3}, vertex_index{1}, vertex_index{4});
+  EXPECT_EQ(components.update(mesh, labels),
+            reference_labels(mesh, always, expected));
+  for (std::size_t i = 0; i < mesh.num_faces(); ++i)
+    EXPECT_EQ(labels[face_index{i}], expected[i]);
+  EXPECT_EQ(labels[face_index{0}], labels[face_index{1}]);
+}
@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+#include "fmesh/decimation.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/geometry.hpp"
+#include "fmesh/validation.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+using mesh_type = fracture_mesh<point, tri_face>;
+
+TEST(DecimationTest, RemoveInvalidEntities) {
+  mesh_type mesh;
+  add_grid(mesh, 2, 2, xz_plane{});
+  mesh.invalidate(face_index{0});
+
+  const auto remap = mesh.remove_invalid_entities();
+
+  EXPECT_FALSE(mesh.has_invalid_entities());
+  EXPECT_EQ(mesh.num_vertices(), 9);
+  EXPECT_EQ(mesh.num_faces(), 7);
+  EXPECT_EQ(mesh.num_edges(), 15);
+  EXPECT_FALSE(remap.edges[edge_index{0}].is_valid());
+  EXPECT_EQ(remap.edges[edge_index{1}], edge_index{0});
+  EXPECT_FALSE(remap.faces[face_index{0}].is_valid());
+  EXPECT_EQ(remap.faces[face_index{1}], face_index{0});
+  for (auto&& fi : mesh.faces()) {
+    for (auto&& ei : mesh.face_edges(fi)) {
+      const auto fs = mesh.edge_faces(ei);
+      EXPECT_NE(std::find(fs.begin(), fs.end(), fi), fs.end());
+    }
+  }
+}
+
+TEST(DecimationTest, PreservesBoundaryAndBranch) {
+  mesh_type mesh;
+  const auto v = add_grid(mesh, 4, 4, xz_plane{});
+
+  // Branch attached to the interior line z = 2
+  std::vector<vertex_index> w;
+  for (int i = 0; i <= 4; ++i) w.push_back(mesh.add_vertex(i, 1.0, 2.0));
+  for (int i = 0; i < 4; ++i) {
+    mesh.add_face(v[10 + i], w[i + 1], v[11 + i]);
+    mesh.add_face(v[10 + i], w[i], w[i + 1]);
+  }
+
+  face_property<int> tag(mesh.num_faces());
+  for (auto&& fi : mesh.faces()) tag[fi] = 1;
+
+  const auto result = decimate(
+      mesh, [&mesh](edge_index ei) { return edge_length(mesh, ei); }, 10.0,
+      [&tag](face_index fi, face_index fj) {
+        tag.resize(fi.get() + 1);
+        tag[fi] = tag[fj];
+      });
+  compact(tag, result.remap.faces);
+
+  // Only the 6 interior vertices off the branching line can be removed.
+  EXPECT_EQ(result.num_collapses, 6);
+  EXPECT_EQ(mesh.num_vertices(), 30 - 6);
+  EXPECT_EQ(mesh.num_faces(), 40 - 12);
+  for (auto&& fi : mesh.faces()) EXPECT_EQ(tag[fi], 1);
+  for (int i = 0; i <= 4; ++i) {
+    EXPECT_TRUE(result.remap.vertices[v[i]].is_valid());
+    EXPECT_TRUE(result.remap.vertices[v[10 + i]].is_valid());
+  }
+}
+
+TEST(DecimationTest, Batches) {
+  const auto length = [](const mesh_type& mesh) {
+    return [&mesh](edge_index ei) { return edge_length(mesh, ei); };
+  };
+
+  // A checkpoint is rejected before any edge is collapsed.
+  mesh_type mesh;
+  add_grid(mesh, 30, 30, xz_plane{});
+  mesh.checkpoint();
+  EXPECT_THROW(decimate(mesh, length(mesh), 10.0), std::logic_error);
+  EXPECT_FALSE(mesh.has_invalid_entities());
+  mesh.release_checkpoint();
+  EXPECT_THROW(decimate(mesh, length(mesh), 10.0, [](auto, auto) {}, 0),
+               std::invalid_argument);
+
+  // One collapse per batch
+  mesh_type single;
+  add_grid(single, 6, 6, xz_plane{});
+  const auto r1 = decimate(single, length(single), 1.5, [](auto, auto) {}, 1);
+  EXPECT_GT(r1.num_collapses, 0);
+  EXPECT_EQ(r1.num_batches, r1.num_collapses);
+  EXPECT_TRUE(validate(single).empty());
+
+  // Batches span several parallel windows of candidates.
+  const auto num_faces = mesh.num_faces();
+  const auto r2 = decimate(mesh, length(mesh), 1.5, [](auto, auto) {}, 64);
+  EXPECT_GT(r2.num_batches, 1);
+  EXPECT_LE(r2.num_collapses, 64 * r2.num_batches);
+  EXPECT_EQ(mesh.num_faces(), num_faces - 2 * r2.num_collapses);
+  EXPECT_TRUE(validate(mesh).empty());
+}
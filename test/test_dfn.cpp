@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include "fmesh/dfn.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/validation.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(DfnTest, CrossingFractures) {
+  dfn_parameters param;
+  param.seed = 7;
+  param.num_fractures = 40;
+  param.num_cells = 16;
+  param.min_length = 4.0;
+  param.max_length = 16.0;
+
+  fracture_mesh<point, quad_face> mesh;
+  const auto result = generate_dfn(mesh, param);
+  EXPECT_EQ(result.fractures.size(), 40);
+  EXPECT_EQ(mesh.num_fractures(), 40);
+  EXPECT_TRUE(mesh.are_fractures_contiguous());
+  EXPECT_FALSE(mesh.fracture_intersections().empty());
+  // Fractures touching at a single lattice point pinch the mesh there.
+  for (auto&& issue : validate(mesh))
+    EXPECT_EQ(issue.kind, issue_kind::non_manifold_vertex) << issue;
+
+  std::size_t num_cells = 0;
+  for (auto&& fr : result.fractures) {
+    for (std::size_t d = 0; d < 2; ++d) {
+      EXPECT_GE(fr.lower[d], 0);
+      EXPECT_LE(fr.upper[d], 16);
+      EXPECT_GE(fr.upper[d] - fr.lower[d], 4);
+    }
+    num_cells += static_cast<std::size_t>((fr.upper[0] - fr.lower[0]) *
+                                          (fr.upper[1] - fr.lower[1]));
+  }
+  EXPECT_LE(mesh.num_faces(), num_cells);
+
+  std::size_t num_branches = 0;
+  for (auto&& ei : mesh.edges()) {
+    if (mesh.edge_faces(ei).size() > 2) ++num_branches;
+    EXPECT_LE(mesh.edge_faces(ei).size(), 4);
+  }
+  EXPECT_GT(num_branches, 0);
+
+  for (auto&& vi : mesh.vertices()) {
+    const auto& p = mesh.vertex(vi);
+    EXPECT_EQ(p.x, std::floor(p.x));
+    EXPECT_GE(p.z, 0.0);
+    EXPECT_LE(p.z, 16.0);
+  }
+}
+
+TEST(DfnTest, Deterministic) {
+  dfn_parameters param;
+  param.seed = 42;
+  param.num_fractures = 20;
+  param.num_cells = 32;
+
+  fracture_mesh<point, tri_face> a;
+  fracture_mesh<point, tri_face> b;
+  fracture_mesh<point, tri_face> c;
+  generate_dfn(a, param);
+  generate_dfn(b, param);
+  param.seed = 43;
+  generate_dfn(c, param);
+
+  ASSERT_EQ(a.num_vertices(), b.num_vertices());
+  ASSERT_EQ(a.num_faces(), b.num_faces());
+  for (auto&& fi : a.faces()) EXPECT_EQ(a.face(fi), b.face(fi));
+  for (auto&& vi : a.vertices()) {
+    EXPECT_EQ(a.vertex(vi).x, b.vertex(vi).x);
+    EXPECT_EQ(a.vertex(vi).y, b.vertex(vi).y);
+    EXPECT_EQ(a.vertex(vi).z, b.vertex(vi).z);
+  }
+  EXPECT_TRUE(a.num_faces() != c.num_faces() ||
+              a.num_vertices() != c.num_vertices());
+  EXPECT_TRUE(validate(a).empty());
+}
+
+TEST(DfnTest, InvalidParameters) {
+  fracture_mesh<point, tri_face> mesh;
+  dfn_parameters param;
+  param.num_cells = 0;
+  EXPECT_THROW(generate_dfn(mesh, param), std::invalid_argument);
+  param.num_cells = 8;
+  param.min_length = 4.0;
+  param.max_length = 2.0;
+  EXPECT_THROW(generate_dfn(mesh, param), std::invalid_argument);
+}
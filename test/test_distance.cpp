@@ -0,0 +1,160 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "fmesh/distance.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+namespace {
+
+constexpr auto inf = std::numeric_limits<double>::infinity();
+
+/// Builds a horizontal plate [0, n h]^2 and, optionally, a vertical plate
+/// x = n h / 2 of height n h / 2 branching from it
+template <typename Mesh>
+void build_plates(Mesh& mesh, std::size_t n, double h, bool is_branching) {
+  const auto vs = add_grid(mesh, n, n, [h](std::size_t i, std::size_t j) {
+    return point{i * h, j * h, 0.0};
+  });
+  if (!is_branching) return;
+
+  std::vector<vertex_index> ws;
+  for (std::size_t k = 0; k <= n / 2; ++k) {
+    for (std::size_t j = 0; j <= n; ++j) {
+      ws.push_back(k == 0 ? vs[j * (n + 1) + n / 2]
+                          : mesh.add_vertex(n / 2 * h, j * h, k * h));
+    }
+  }
+  add_grid_faces(mesh, ws, n, n / 2);
+}
+
+template <typename Mesh>
+std::vector<distance_seed> left_side(const Mesh& mesh) {
+  std::vector<distance_seed> seeds;
+  for (auto&& vi : mesh.vertices())
+    if (mesh.vertex(vi).x == 0.0) seeds.push_back({vi, 0.0});
+  return seeds;
+}
+
+template <typename Mesh>
+void test_planar_front(distance_method method) {
+  Mesh mesh;
+  build_plates(mesh, 8, 0.25, true);
+  distance_options options;
+  options.method = method;
+  const auto d = geodesic_distance(mesh, left_side(mesh), options);
+
+  // The front crosses the branching edges and climbs the vertical plate.
+  for (auto&& vi : mesh.vertices()) {
+    const auto& p = mesh.vertex(vi);
+    const auto expected = p.z > 0.0 ? 1.0 + p.z : p.x;
+    EXPECT_NEAR(d[vi], expected, 1e-9) << vi;
+  }
+}
+
+}  // namespace
+
+TEST(DistanceTest, PlanarFrontAcrossBranches) {
+  test_planar_front<fracture_mesh<point, tri_face>>(
+      distance_method::fast_marching);
+  test_planar_front<fracture_mesh<point, tri_face>>(
+      distance_method::parallel_sweep);
+  test_planar_front<fracture_mesh<point, quad_face>>(
+      distance_method::fast_marching);
+  test_planar_front<fracture_mesh<point, quad_face, std::allocator<point>,
+                                  minimal_relations>>(
+      distance_method::parallel_sweep);
+}
+
+TEST(DistanceTest, PointSource) {
+  fracture_mesh<point, tri_face> mesh;
+  build_plates(mesh, 20, 0.1, false);
+  const vertex_index center{10 * 21 + 10};
+  const std::vector<distance_seed> seeds = {{center, 0.0}};
+
+  distance_options options;
+  const auto serial = geodesic_distance(mesh, seeds, options);
+  options.method = distance_method::parallel_sweep;
+  options.grain = 16;
+  const auto parallel = geodesic_distance(mesh, seeds, options);
+
+  double max_error = 0.0;
+  double max_difference = 0.0;
+  for (auto&& vi : mesh.vertices()) {
+    const auto& p = mesh.vertex(vi);
+    const auto r = std::hypot(p.x - 1.0, p.y - 1.0);
+    EXPECT_GE(serial[vi], r - 1e-9);
+    max_error = std::max(max_error, serial[vi] - r);
+    max_difference =
+        std::max(max_difference, std::abs(serial[vi] - parallel[vi]));
+  }
+  // Fast marching is first-order accurate around a point source.
+  EXPECT_LT(max_error, 0.1);
+  EXPECT_LT(max_difference, 1e-9);
+}
+
+TEST(DistanceTest, NarrowBand) {
+  fracture_mesh<point, tri_face> mesh;
+  build_plates(mesh, 8, 0.25, true);
+  const auto seeds = left_side(mesh);
+
+  distance_options options;
+  options.max_distance = 0.6;
+  vertex_property<double> d;
+  distance_workspace work;
+  geodesic_distance(mesh, seeds, d, work, options);
+  ASSERT_EQ(d.size(), mesh.num_vertices());
+  EXPECT_EQ(work.band().size(), 3 * 9);
+  for (auto&& vi : mesh.vertices()) {
+    const auto x = mesh.vertex(vi).x;
+    EXPECT_EQ(d[vi], x <= 0.6 ? x : inf) << vi;
+  }
+
+  // The next front resets only the last band.
+  const std::vector<distance_seed> tip = {{vertex_index{8}, 0.0}};
+  options.method = distance_method::parallel_sweep;
+  options.max_distance = 0.3;
+  geodesic_distance(mesh, tip, d, work, options);
+  for (auto&& vi : mesh.vertices()) {
+    const auto& p = mesh.vertex(vi);
+    const auto r = std::hypot(p.x - 2.0, p.y);
+    if (r > 0.3 + 1e-9) {
+      EXPECT_EQ(d[vi], inf) << vi;
+    } else {
+      EXPECT_NEAR(d[vi], r, 1e-9) << vi;
+    }
+  }
+  EXPECT_EQ(work.band().size(), 3);
+
+  const std::vector<distance_seed> invalid = {
+      {vertex_index{mesh.num_vertices()}, 0.0}};
+  EXPECT_THROW(geodesic_distance(mesh, invalid, d, work, options),
+               std::invalid_argument);
+}
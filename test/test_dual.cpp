@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include "fmesh/dual.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(DualTest, QuadMeshWithBranch) {
+  fracture_mesh<point, quad_face> mesh;
+  add_grid(mesh, 2, 2);
+  const auto id = [](int i, int j) {
+    return vertex_index{static_cast<std::size_t>(j * 3 + i)};
+  };
+  // A branch standing on the edge between (1, 0) and (1, 1)
+  const auto a = mesh.add_vertex(1.0, 1.0, 1.0);
+  const auto b = mesh.add_vertex(1.0, 0.0, 1.0);
+  mesh.add_face(id(1, 0), id(1, 1), a, b);
+
+  const auto dual = median_dual(mesh);
+  EXPECT_EQ(dual.num_face_vertices, 4u);
+  EXPECT_DOUBLE_EQ(dual.volumes[id(1, 1)], 1.25);
+  EXPECT_DOUBLE_EQ(dual.volumes[id(1, 0)], 0.75);
+  EXPECT_DOUBLE_EQ(dual.volumes[id(0, 0)], 0.25);
+  EXPECT_DOUBLE_EQ(std::accumulate(dual.volumes.begin(), dual.volumes.end(),
+                                   0.0),
+                   5.0);
+
+  // The dual face crossing the first edge of the first face
+  EXPECT_EQ(dual.edges[0], mesh.face_edges(face_index{0}).begin()[0]);
+  EXPECT_DOUBLE_EQ(dual.lengths[0], 0.5);
+  EXPECT_DOUBLE_EQ(dual.normals[0].x, 1.0);
+  EXPECT_DOUBLE_EQ(dual.normals[0].y, 0.0);
+  EXPECT_DOUBLE_EQ(dual.normals[0].z, 0.0);
+
+  // The branch face crosses from (1, 1, 1) to (1, 0, 1) along -y.
+  EXPECT_DOUBLE_EQ(dual.normals[4 * 4 + 2].y, -1.0);
+  EXPECT_DOUBLE_EQ(dual.lengths[4 * 4 + 2], 0.5);
+}
+
+TEST(DualTest, TriangleCorners) {
+  fracture_mesh<point, tri_face> mesh;
+  const auto v0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto v1 = mesh.add_vertex(3.0, 0.0, 0.0);
+  const auto v2 = mesh.add_vertex(0.0, 2.0, 0.0);
+  const auto v3 = mesh.add_vertex(3.0, 2.0, 0.0);
+  mesh.add_face(v0, v1, v2);
+  mesh.add_face(v1, v3, v2);
+  mesh.invalidate(face_index{1});
+
+  const auto dual = median_dual(mesh);
+  EXPECT_DOUBLE_EQ(dual.volumes[v0], 1.0);
+  EXPECT_DOUBLE_EQ(dual.volumes[v1], 1.0);
+  EXPECT_DOUBLE_EQ(dual.volumes[v3], 0.0);
+  EXPECT_DOUBLE_EQ(dual.corner_areas[3], 0.0);
+  EXPECT_FALSE(dual.edges[3].is_valid());
+
+  // Dual faces of a triangle are balanced around its centroid.
+  vector3 sum;
+  for (std::size_t k = 0; k < 3; ++k) sum += dual.lengths[k] * dual.normals[k];
+  EXPECT_NEAR(norm(sum), 0.0, 1e-12);
+}
@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "fmesh/face_connections.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(FaceConnectionsTest, BranchingEdge) {
+  fracture_mesh<point, tri_face> mesh;
+
+  std::vector<vertex_index> v;
+  v.push_back(mesh.add_vertex(0.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(0.0, 0.0, 1.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 1.0));
+  v.push_back(mesh.add_vertex(0.5, 1.0, 0.5));
+  v.push_back(mesh.add_vertex(0.0, 1.0, 0.0));
+
+  std::vector<face_index> f;
+  f.push_back(mesh.add_face(v[0], v[1], v[2]));
+  f.push_back(mesh.add_face(v[1], v[3], v[2]));
+  f.push_back(mesh.add_face(v[1], v[4], v[2]));
+  f.push_back(mesh.add_face(v[1], v[5], v[4]));
+
+  face_connections connections{true};
+  connections.build(mesh);
+
+  // Three pairs at the branching edge and one at the edge (1, 4)
+  ASSERT_EQ(connections.size(), 4);
+  const auto e12 = mesh.find(undirected_edge{v[1], v[2]});
+  const auto e14 = mesh.find(undirected_edge{v[1], v[4]});
+  for (std::size_t k = 0; k < 3; ++k) EXPECT_EQ(connections.edges()[k], e12);
+  EXPECT_EQ(connections.edges()[3], e14);
+  EXPECT_EQ(connections.first_faces()[2], f[1]);
+  EXPECT_EQ(connections.second_faces()[2], f[2]);
+  EXPECT_DOUBLE_EQ(connections.edge_lengths()[0], std::sqrt(2.0));
+  EXPECT_DOUBLE_EQ(connections.first_distances()[0],
+                   std::sqrt(2.0) / 6.0);
+
+  mesh.invalidate(f[2]);
+  std::vector<edge_index> changed;
+  for (auto&& ei : mesh.face_edges(f[2])) changed.push_back(ei);
+  connections.update(mesh, changed);
+
+  ASSERT_EQ(connections.size(), 1);
+  EXPECT_EQ(connections.edges()[0], e12);
+  EXPECT_EQ(connections.first_faces()[0], f[0]);
+  EXPECT_EQ(connections.second_faces()[0], f[1]);
+  EXPECT_EQ(connections.first_distances().size(), 1);
+}
+
+void expect_same(const face_connections& a, const face_connections& b) {
+  EXPECT_EQ(a.first_faces(), b.first_faces());
+  EXPECT_EQ(a.second_faces(), b.second_faces());
+  EXPECT_EQ(a.edges(), b.edges());
+  EXPECT_EQ(a.edge_lengths(), b.edge_lengths());
+  EXPECT_EQ(a.first_distances(), b.first_distances());
+  EXPECT_EQ(a.second_distances(), b.second_distances());
+}
+
+TEST(FaceConnectionsTest, Update) {
+  fracture_mesh<point, tri_face> mesh;
+  add_grid(mesh, 2, 2);
+  const auto v = [](int i, int j) {
+    return vertex_index{static_cast<std::size_t>(j * 3 + i)};
+  };
+  face_connections connections{true};
+  connections.build(mesh);
+  face_connections expected{true};
+
+  // Moving a vertex keeps the number of connections of every edge.
+  const auto centre = v(1, 1);
+  mesh.move_vertex(centre, point{1.2, 0.9, 0.1});
+  std::vector<edge_index> changed;
+  for (auto&& fi : mesh.faces()) {
+    const auto& f = mesh.face(fi);
+    if (std::find(f.begin(), f.end(), centre) == f.end()) continue;
+    for (auto&& ei : mesh.face_edges(fi)) changed.push_back(ei);
+  }
+  connections.update(mesh, changed);
+  expected.build(mesh);
+  expect_same(connections, expected);
+
+  // A branch adds connections to an edge in the middle and new edges.
+  const auto e = mesh.find(undirected_edge{v(0, 1), centre});
+  const auto top = mesh.add_vertex(0.5, 1.0, 1.0);
+  const auto fi = mesh.add_face(v(0, 1), centre, top);
+  changed.assign(mesh.face_edges(fi).begin(), mesh.face_edges(fi).end());
+  EXPECT_TRUE(std::find(changed.begin(), changed.end(), e) != changed.end());
+  connections.update(mesh, changed);
+  expected.build(mesh);
+  expect_same(connections, expected);
+
+  // Removing a face removes connections.
+  mesh.invalidate(face_index{0});
+  changed.assign(mesh.face_edges(face_index{0}).begin(),
+                 mesh.face_edges(face_index{0}).end());
+  connections.update(mesh, changed);
+  expected.build(mesh);
+  expect_same(connections, expected);
+}
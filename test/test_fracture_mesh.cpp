@@ -21,21 +21,19 @@
 // SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include "fmesh/fixed_size_face.hpp"
 #include "fmesh/fracture_mesh.hpp"
+#include "fmesh/geometry.hpp"
+#include "fmesh/validation.hpp"
+#include "test_util.hpp"
 
 using namespace fmesh;
 
-struct point {
-  double x;
-  double y;
-  double z;
-
-  point() = default;
-  point(double tx, double ty, double tz) : x{tx}, y{ty}, z{tz} {}
-};
-
 TEST(FmeshTest, FractureMeshTest) {
   fracture_mesh<point, tri_face> mesh;
 
@@ -69,4 +67,594 @@ TEST(FmeshTest, FractureMeshTest) {
   EXPECT_TRUE(mesh.is_valid(v_ids[1]));
   EXPECT_TRUE(mesh.is_valid(v_ids[2]));
   EXPECT_TRUE(mesh.is_valid(v_ids[3]));
-}
\ No newline at end of file
+}
+namespace {
+
+template <typename Mesh>
+void test_readd_invalidated_face() {
+  Mesh mesh;
+  const auto a = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto b = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto c = mesh.add_vertex(0.0, 1.0, 0.0);
+  const auto f0 = mesh.add_face(a, b, c);
+  mesh.invalidate(f0);
+  EXPECT_FALSE(mesh.is_valid(a));
+
+  // Vertices invalidated with the face are valid again.
+  const auto f1 = mesh.add_face(a, b, c);
+  ASSERT_TRUE(f1.is_valid());
+  for (auto&& vi : {a, b, c}) EXPECT_TRUE(mesh.is_valid(vi));
+  EXPECT_EQ(mesh.find(tri_face{a, b, c}), f1);
+  EXPECT_TRUE(validate(mesh).empty());
+
+  // The valid duplicate is found even behind the invalid one.
+  EXPECT_FALSE(mesh.add_face(a, b, c).is_valid());
+  EXPECT_EQ(mesh.num_faces(), 2);
+
+  const auto remap = mesh.remove_invalid_entities();
+  EXPECT_EQ(mesh.num_vertices(), 3);
+  EXPECT_EQ(mesh.num_edges(), 3);
+  ASSERT_EQ(mesh.num_faces(), 1);
+  EXPECT_EQ(remap.faces[f1], face_index{0});
+  EXPECT_EQ(mesh.face(face_index{0}), (tri_face{a, b, c}));
+  EXPECT_TRUE(validate(mesh).empty());
+}
+
+}  // namespace
+
+TEST(FmeshTest, ReaddInvalidatedFace) {
+  test_readd_invalidated_face<fracture_mesh<point, tri_face>>();
+  test_readd_invalidated_face<fracture_mesh<
+      point, tri_face, std::allocator<point>, minimal_relations>>();
+}
+
+TEST(FmeshTest, ReserveAndShrinkToFit) {
+  fracture_mesh<point, quad_face> mesh;
+  const int n = 8;
+  mesh.reserve((n + 1) * (n + 1), 2 * n * (n + 1), n * n, 4);
+
+  add_grid(mesh, n, n, xz_plane{});
+
+  const auto before = mesh.memory_usage();
+  for (std::size_t k : {0, 1, 2}) {
+    EXPECT_EQ(before[k].size_bytes, before[k].capacity_bytes);
+  }
+  // Each vertex list was allocated once.
+  EXPECT_EQ(before[4].name, "vertex_edges");
+  EXPECT_EQ(before[4].heap_blocks, 1 + mesh.num_vertices());
+
+  mesh.shrink_to_fit();
+  const auto after = mesh.memory_usage();
+  for (std::size_t k = 0; k < 8; ++k) {
+    EXPECT_EQ(after[k].size_bytes, after[k].capacity_bytes);
+  }
+}
+
+TEST(FmeshTest, CheckpointRollback) {
+  fracture_mesh<point, tri_face> mesh;
+  const auto v0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto v1 = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto v2 = mesh.add_vertex(0.0, 1.0, 0.0);
+  const auto v3 = mesh.add_vertex(1.0, 1.0, 0.0);
+  const auto f0 = mesh.add_face(v0, v1, v2);
+  const auto f1 = mesh.add_face(v1, v3, v2);
+  mesh.invalidate(f1);
+  const auto copy = mesh;
+
+  const auto expect_same = [&copy](const auto& m) {
+    EXPECT_EQ(m.num_vertices(), copy.num_vertices());
+    EXPECT_EQ(m.num_edges(), copy.num_edges());
+    EXPECT_EQ(m.num_faces(), copy.num_faces());
+    EXPECT_EQ(m.has_invalid_entities(), copy.has_invalid_entities());
+    for (auto&& vi : copy.vertices()) {
+      EXPECT_EQ(m.is_valid(vi), copy.is_valid(vi));
+      EXPECT_EQ(m.vertex_edges(vi).size(), copy.vertex_edges(vi).size());
+      EXPECT_EQ(m.vertex_vertices(vi).size(), copy.vertex_vertices(vi).size());
+      EXPECT_EQ(m.vertex_faces(vi).size(), copy.vertex_faces(vi).size());
+    }
+    for (auto&& ei : copy.edges()) {
+      EXPECT_EQ(m.is_valid(ei), copy.is_valid(ei));
+      EXPECT_EQ(m.edge_faces(ei).size(), copy.edge_faces(ei).size());
+    }
+    for (auto&& fi : copy.faces()) EXPECT_EQ(m.is_valid(fi), copy.is_valid(fi));
+  };
+
+  mesh.checkpoint();
+  // Reuses invalidated edges and creates new ones.
+  const auto v4 = mesh.add_vertex(2.0, 0.0, 0.0);
+  mesh.add_face(v1, v3, v2);
+  mesh.add_face(v1, v4, v3);
+  mesh.checkpoint();
+  mesh.invalidate(v0);
+  EXPECT_EQ(mesh.num_checkpoints(), 2u);
+  EXPECT_THROW(mesh.remove_invalid_entities(), std::logic_error);
+
+  mesh.rollback();
+  EXPECT_TRUE(mesh.is_valid(f0));
+  EXPECT_TRUE(mesh.is_valid(v0));
+  mesh.rollback();
+  EXPECT_EQ(mesh.num_checkpoints(), 0u);
+  expect_same(mesh);
+
+  // Released changes are kept.
+  mesh.checkpoint();
+  mesh.invalidate(f0);
+  mesh.release_checkpoint();
+  EXPECT_FALSE(mesh.is_valid(f0));
+  mesh.remove_invalid_entities();
+  EXPECT_EQ(mesh.num_faces(), 0u);
+}
+
+TEST(FmeshTest, RawStorage) {
+  fracture_mesh<point, tri_face> mesh;
+  const auto v0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto v1 = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto v2 = mesh.add_vertex(0.0, 1.0, 0.0);
+  const auto v3 = mesh.add_vertex(1.0, 1.0, 0.0);
+  mesh.add_face(v0, v1, v2);
+  const auto f1 = mesh.add_face(v1, v3, v2);
+  mesh.invalidate(f1);
+
+  const auto points = mesh.points();
+  ASSERT_EQ(points.size(), 4u);
+  EXPECT_EQ(mesh.point_stride, 3 * sizeof(double));
+  EXPECT_EQ(points.begin()[3].x, 1.0);
+
+  const auto fvs = mesh.face_vertex_array();
+  const std::vector<vertex_index> expected_fvs{v0, v1, v2, v1, v3, v2};
+  EXPECT_TRUE(std::equal(fvs.begin(), fvs.end(), expected_fvs.begin(),
+                         expected_fvs.end()));
+
+  const auto evs = mesh.edge_vertex_array();
+  ASSERT_EQ(evs.size(), 2 * mesh.num_edges());
+  for (auto&& ei : mesh.edges()) {
+    EXPECT_EQ(evs.begin()[2 * ei.get()], mesh.edge(ei).first);
+    EXPECT_EQ(evs.begin()[2 * ei.get() + 1], mesh.edge(ei).second);
+  }
+
+  const auto vflags = mesh.vertex_validity();
+  EXPECT_EQ(std::vector<std::uint8_t>(vflags.begin(), vflags.end()),
+            (std::vector<std::uint8_t>{1, 1, 1, 0}));
+  const auto fflags = mesh.face_validity();
+  EXPECT_EQ(std::vector<std::uint8_t>(fflags.begin(), fflags.end()),
+            (std::vector<std::uint8_t>{1, 0}));
+  EXPECT_EQ(mesh.edge_validity().size(), mesh.num_edges());
+
+  vertex_property<double> pressure{1.0, 2.0};
+  EXPECT_EQ(pressure.data()[1], 2.0);
+}
+
+TEST(FmeshTest, MinimalRelations) {
+  fracture_mesh<point, tri_face> full;
+  fracture_mesh<point, tri_face, std::allocator<point>, minimal_relations>
+      minimal;
+  const auto build = [](auto& mesh) { add_grid(mesh, 2, 2); };
+  const auto expect_same = [](const auto& m1, const auto& m2) {
+    ASSERT_EQ(m1.num_vertices(), m2.num_vertices());
+    EXPECT_EQ(m1.num_edges(), m2.num_edges());
+    EXPECT_EQ(m1.num_faces(), m2.num_faces());
+    for (auto&& vi : m1.vertices()) {
+      EXPECT_EQ(m1.is_valid(vi), m2.is_valid(vi));
+      const auto vs1 = m1.vertex_vertices(vi);
+      const auto vs2 = m2.vertex_vertices(vi);
+      EXPECT_TRUE(std::equal(vs1.begin(), vs1.end(), vs2.begin(), vs2.end()));
+      const auto fs1 = m1.vertex_faces(vi);
+      const auto fs2 = m2.vertex_faces(vi);
+      EXPECT_TRUE(std::equal(fs1.begin(), fs1.end(), fs2.begin(), fs2.end()));
+    }
+    for (auto&& ei : m1.edges()) EXPECT_EQ(m1.is_valid(ei), m2.is_valid(ei));
+    for (auto&& fi : m1.faces()) EXPECT_EQ(m1.is_valid(fi), m2.is_valid(fi));
+  };
+
+  build(full);
+  build(minimal);
+  // Relations which are not maintained are not stored until requested.
+  EXPECT_EQ(minimal.memory_usage()[3].capacity_bytes, 0u);
+  EXPECT_EQ(minimal.memory_usage()[5].capacity_bytes, 0u);
+  EXPECT_FALSE(minimal.add_face(vertex_index{0}, vertex_index{1},
+                                vertex_index{4})
+                   .is_valid());
+  expect_same(full, minimal);
+
+  full.checkpoint();
+  minimal.checkpoint();
+  full.invalidate(vertex_index{4});
+  minimal.invalidate(vertex_index{4});
+  expect_same(full, minimal);
+  full.add_vertex(3.0, 0.0, 0.0);
+  minimal.add_vertex(3.0, 0.0, 0.0);
+  full.add_face(vertex_index{2}, vertex_index{9}, vertex_index{5});
+  minimal.add_face(vertex_index{2}, vertex_index{9}, vertex_index{5});
+  expect_same(full, minimal);
+
+  full.rollback();
+  minimal.rollback();
+  expect_same(full, minimal);
+
+  full.invalidate(face_index{0});
+  minimal.invalidate(face_index{0});
+  full.remove_invalid_entities();
+  minimal.remove_invalid_entities();
+  expect_same(full, minimal);
+}
+
+namespace {
+
+template <typename Mesh>
+void test_local_editing() {
+  const auto v = [](std::size_t i) { return vertex_index{i}; };
+  const auto edge_of = [](const Mesh& mesh, std::size_t i, std::size_t j) {
+    using edge_type = typename Mesh::edge_type;
+    return mesh.find(edge_type{vertex_index{i}, vertex_index{j}});
+  };
+  const auto count_valid_faces = [](const Mesh& mesh) {
+    std::size_t n = 0;
+    for (auto&& fi : mesh.faces()) n += mesh.is_valid(fi);
+    return n;
+  };
+
+  {
+    // Splits a branching edge shared by three faces.
+    Mesh mesh;
+    add_grid(mesh, 2, 2);
+    const auto top = mesh.add_vertex(1.5, 1.5, 1.0);
+    mesh.add_face(v(4), v(8), top);
+    const auto ei = edge_of(mesh, 4, 8);
+    ASSERT_EQ(mesh.edge_faces(ei).size(), 3);
+
+    const auto edit = mesh.split_edge(ei, point{1.5, 1.5, 0.0});
+    EXPECT_EQ(edit.vertex, v(10));
+    EXPECT_EQ(edit.new_faces.size(), 3);
+    EXPECT_EQ(edit.modified_faces.size(), 3);
+    EXPECT_EQ(edit.new_edges.size(), 4);
+    EXPECT_TRUE(edit.removed_edges.empty());
+    EXPECT_EQ(edit.modified_edges, std::vector<edge_index>{ei});
+    EXPECT_EQ(mesh.num_faces(), 12);
+    EXPECT_FALSE(mesh.has_invalid_entities());
+    EXPECT_TRUE(validate(mesh).empty());
+    // The split edge is reused for one half.
+    EXPECT_TRUE(mesh.edge(ei).contains(v(10)));
+    EXPECT_EQ(mesh.edge_faces(ei).size(), 3);
+    EXPECT_EQ(mesh.edge_faces(edge_of(mesh, 4, 10)).size(), 3);
+    EXPECT_EQ(mesh.edge_faces(edge_of(mesh, 10, 8)).size(), 3);
+    for (auto&& [fi, parent] : edit.new_faces) {
+      EXPECT_TRUE(mesh.face(fi).contains(v(10)));
+      EXPECT_TRUE(mesh.face(parent).contains(v(10)));
+    }
+    // Faces keep their orientation.
+    for (auto&& fi : mesh.faces()) {
+      if (!mesh.face(fi).contains(top)) {
+        EXPECT_GT(area_vector(mesh, mesh.face(fi)).z, 0.0);
+      }
+    }
+  }
+  {
+    Mesh mesh;
+    add_grid(mesh, 2, 2);
+    const auto edit = mesh.split_face(face_index{0}, point{0.7, 0.3, 0.0});
+    EXPECT_EQ(edit.new_faces.size(), 2);
+    EXPECT_EQ(edit.new_edges.size(), 3);
+    EXPECT_EQ(mesh.num_faces(), 10);
+    EXPECT_TRUE(validate(mesh).empty());
+    for (auto&& fi : mesh.faces())
+      EXPECT_GT(area_vector(mesh, mesh.face(fi)).z, 0.0);
+  }
+  {
+    Mesh mesh;
+    add_grid(mesh, 2, 2);
+    const auto ei = edge_of(mesh, 0, 4);
+    const auto edit = mesh.flip_edge(ei);
+    EXPECT_EQ(edit.modified_faces.size(), 2);
+    EXPECT_TRUE(edit.new_edges.empty());
+    EXPECT_EQ(edit.modified_edges, std::vector<edge_index>{ei});
+    EXPECT_EQ(mesh.edge(ei), (typename Mesh::edge_type{v(1), v(3)}));
+    EXPECT_FALSE(edge_of(mesh, 0, 4).is_valid());
+    EXPECT_TRUE(validate(mesh).empty());
+    for (auto&& fi : mesh.faces())
+      EXPECT_GT(area_vector(mesh, mesh.face(fi)).z, 0.0);
+
+    EXPECT_THROW(mesh.flip_edge(edge_of(mesh, 0, 1)), std::invalid_argument);
+    mesh.add_face(v(4), v(8), mesh.add_vertex(1.5, 1.5, 1.0));
+    EXPECT_THROW(mesh.flip_edge(edge_of(mesh, 4, 8)), std::invalid_argument);
+  }
+  {
+    // The flipped edge was invalidated before and is used again.
+    Mesh mesh;
+    add_grid(mesh, 2, 2);
+    const auto t = mesh.add_vertex(0.0, 0.0, 1.0);
+    mesh.invalidate(mesh.add_face(v(1), v(3), t));
+    const auto ej = edge_of(mesh, 1, 3);
+    ASSERT_FALSE(mesh.is_valid(ej));
+    const auto ei = edge_of(mesh, 0, 4);
+    const auto edit = mesh.flip_edge(ei);
+    EXPECT_EQ(edit.removed_edges, std::vector<edge_index>{ei});
+    EXPECT_EQ(edit.modified_edges, std::vector<edge_index>{ej});
+    EXPECT_TRUE(mesh.is_valid(ej));
+  }
+  {
+    // Merges the center vertex into a boundary vertex.
+    Mesh mesh;
+    add_grid(mesh, 2, 2);
+    const auto ei = edge_of(mesh, 4, 5);
+    const auto a = mesh.edge(ei).first;
+    const auto b = mesh.edge(ei).second;
+    const auto edit = mesh.collapse_edge(ei, point{2.0, 1.0, 0.0});
+    EXPECT_EQ(edit.vertex, b);
+    EXPECT_EQ(edit.removed_faces.size(), 2);
+    // Edges (b, x) are moved to (a, x) unless (a, x) exists.
+    EXPECT_EQ(edit.modified_edges.size(), 3);
+    for (auto&& ej : edit.modified_edges) {
+      EXPECT_TRUE(mesh.is_valid(ej));
+      EXPECT_TRUE(mesh.edge(ej).contains(a));
+    }
+    EXPECT_FALSE(mesh.is_valid(b));
+    EXPECT_TRUE(mesh.is_valid(a));
+    EXPECT_EQ(count_valid_faces(mesh), 6);
+    EXPECT_TRUE(validate(mesh).empty());
+    for (auto&& fi : mesh.faces()) {
+      if (mesh.is_valid(fi)) {
+        EXPECT_FALSE(mesh.face(fi).contains(b));
+        EXPECT_GT(area_vector(mesh, mesh.face(fi)).z, 0.0);
+      }
+    }
+    mesh.remove_invalid_entities();
+    EXPECT_EQ(mesh.num_vertices(), 8);
+    EXPECT_EQ(mesh.num_edges(), 13);
+    EXPECT_TRUE(validate(mesh).empty());
+  }
+  {
+    // The ends share a neighbor which is not opposite to the edge.
+    Mesh mesh;
+    for (int i = 0; i < 6; ++i) mesh.add_vertex(i, i % 2, 0.0);
+    mesh.add_face(v(0), v(1), v(2));
+    mesh.add_face(v(0), v(3), v(4));
+    mesh.add_face(v(1), v(4), v(5));
+    EXPECT_THROW(mesh.collapse_edge(edge_of(mesh, 0, 1), point{}),
+                 std::invalid_argument);
+
+    // Collapsing an edge of a tetrahedron duplicates faces.
+    Mesh tet;
+    for (int i = 0; i < 4; ++i) tet.add_vertex(i == 1, i == 2, i == 3);
+    tet.add_face(v(0), v(2), v(1));
+    tet.add_face(v(0), v(1), v(3));
+    tet.add_face(v(1), v(2), v(3));
+    tet.add_face(v(0), v(3), v(2));
+    EXPECT_THROW(tet.collapse_edge(edge_of(tet, 0, 1), point{}),
+                 std::invalid_argument);
+    EXPECT_TRUE(validate(tet).empty());
+  }
+  {
+    Mesh mesh;
+    add_grid(mesh, 2, 2);
+    mesh.invalidate(face_index{0});
+    EXPECT_THROW(mesh.split_face(face_index{0}, point{}),
+                 std::invalid_argument);
+    mesh.checkpoint();
+    EXPECT_THROW(mesh.split_edge(edge_of(mesh, 4, 8), point{}),
+                 std::logic_error);
+  }
+}
+
+}  // namespace
+
+TEST(FmeshTest, LocalEditing) {
+  test_local_editing<fracture_mesh<point, tri_face>>();
+  test_local_editing<fracture_mesh<point, tri_face, std::allocator<point>,
+                                   minimal_relations>>();
+}
+
+TEST(FmeshTest, ChangeTracking) {
+  using kind = mesh_change::kind;
+  fracture_mesh<point, tri_face> mesh;
+  add_grid(mesh, 2, 2);
+  EXPECT_FALSE(mesh.is_tracking_changes());
+  EXPECT_GT(mesh.epoch(), 0);
+  EXPECT_FALSE(mesh.has_changes_since(0));
+  EXPECT_THROW(mesh.changes_since(0), std::out_of_range);
+
+  mesh.track_changes(true);
+  const auto e0 = mesh.epoch();
+  EXPECT_TRUE(mesh.has_changes_since(e0));
+  EXPECT_TRUE(mesh.changes_since(e0).empty());
+
+  const auto vi = mesh.add_vertex(3.0, 0.0, 0.0);
+  const auto fi = mesh.add_face(vertex_index{2}, vi, vertex_index{5});
+  auto changes = mesh.changed_since(e0);
+  EXPECT_FALSE(changes.renumbered);
+  EXPECT_EQ(changes.vertices, std::vector<vertex_index>{vi});
+  EXPECT_EQ(changes.edges.size(), 2);
+  EXPECT_EQ(changes.faces, std::vector<face_index>{fi});
+  EXPECT_EQ(mesh.epoch(), e0 + 4);
+
+  // Another consumer starts here.
+  const auto e1 = mesh.epoch();
+  mesh.move_vertex(vertex_index{4}, point{1.1, 1.0, 0.0});
+  mesh.invalidate(face_index{0});
+  changes = mesh.changed_since(e1);
+  EXPECT_EQ(changes.vertices, std::vector<vertex_index>{vertex_index{4}});
+  EXPECT_EQ(changes.faces, std::vector<face_index>{face_index{0}});
+  EXPECT_EQ(mesh.changes_since(e1).begin()->change, kind::modified);
+  EXPECT_EQ(mesh.changes_since(e1).begin()[1].change, kind::invalidated);
+  EXPECT_EQ(mesh.changed_since(e0).vertices.size(), 2);
+
+  mesh.discard_changes(e1);
+  EXPECT_FALSE(mesh.has_changes_since(e0));
+  EXPECT_TRUE(mesh.has_changes_since(e1));
+
+  const auto e2 = mesh.epoch();
+  const auto edit = mesh.split_edge(
+      mesh.find(undirected_edge{vertex_index{4}, vertex_index{8}}),
+      point{1.5, 1.5, 0.0});
+  changes = mesh.changed_since(e2);
+  EXPECT_EQ(changes.vertices, std::vector<vertex_index>{edit.vertex});
+  EXPECT_EQ(changes.faces.size(), 4);
+  EXPECT_EQ(changes.edges.size(), 1 + edit.new_edges.size());
+
+  mesh.remove_invalid_entities();
+  EXPECT_TRUE(mesh.changed_since(e2).renumbered);
+  EXPECT_TRUE(mesh.changed_since(e1).renumbered);
+
+  mesh.track_changes(false);
+  EXPECT_FALSE(mesh.has_changes_since(e2));
+  EXPECT_TRUE(mesh.has_changes_since(mesh.epoch()));
+}
+
+TEST(FmeshTest, FractureGrouping) {
+  fracture_mesh<point, tri_face> mesh;
+  add_grid(mesh, 2, 2);
+  EXPECT_EQ(mesh.num_fractures(), 1);
+  EXPECT_EQ(mesh.current_fracture(), fracture_index{0});
+
+  // A vertical fracture crossing the grid along x = 1
+  const auto k = mesh.add_fracture();
+  EXPECT_EQ(k, fracture_index{1});
+  const auto v9 = mesh.add_vertex(1.0, 0.0, 1.0);
+  const auto v10 = mesh.add_vertex(1.0, 1.0, 1.0);
+  const auto v11 = mesh.add_vertex(1.0, 2.0, 1.0);
+  const vertex_index v1{1}, v4{4}, v7{7};
+  mesh.add_face(v1, v4, v10);
+  mesh.add_face(v1, v10, v9);
+  mesh.add_face(v4, v7, v11);
+  mesh.add_face(v4, v11, v10);
+  EXPECT_EQ(mesh.num_fractures(), 2);
+  ASSERT_TRUE(mesh.are_fractures_contiguous());
+
+  const auto f0 = mesh.fracture(fracture_index{0});
+  const auto f1 = mesh.fracture(k);
+  EXPECT_EQ(f0.num_faces(), 8);
+  EXPECT_EQ(f1.num_faces(), 4);
+  EXPECT_EQ(*f1.faces().begin(), face_index{8});
+  EXPECT_TRUE(f1.contains(face_index{11}));
+  EXPECT_FALSE(f1.contains(face_index{7}));
+  for (auto&& fi : f1.faces()) EXPECT_EQ(mesh.face_fracture(fi), k);
+  EXPECT_EQ(mesh.fracture(fracture_index{5}).num_faces(), 0);
+
+  const auto intersections = mesh.fracture_intersections();
+  ASSERT_EQ(intersections.size(), 1);
+  EXPECT_EQ(intersections[0].first, fracture_index{0});
+  EXPECT_EQ(intersections[0].second, k);
+  auto expected = std::vector<edge_index>{
+      mesh.find(undirected_edge{v1, v4}), mesh.find(undirected_edge{v4, v7})};
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(intersections[0].edges, expected);
+
+  // Faces added to an earlier fracture break contiguity until compaction.
+  mesh.set_current_fracture(fracture_index{0});
+  const auto v12 = mesh.add_vertex(3.0, 0.0, 0.0);
+  const auto fi = mesh.add_face(vertex_index{2}, v12, vertex_index{5});
+  EXPECT_FALSE(mesh.are_fractures_contiguous());
+  EXPECT_THROW(mesh.fracture(k), std::logic_error);
+  mesh.set_face_fracture(face_index{11}, fracture_index{2});
+  EXPECT_EQ(mesh.num_fractures(), 3);
+  mesh.invalidate(face_index{0});
+
+  face_property<std::size_t> ids(mesh.num_faces());
+  for (auto&& fj : mesh.faces()) ids[fj] = fj.get();
+  const auto remap = mesh.remove_invalid_entities();
+  compact(ids, remap.faces);
+  EXPECT_TRUE(mesh.are_fractures_contiguous());
+  EXPECT_EQ(remap.faces[fi], face_index{7});
+  EXPECT_EQ(remap.faces[face_index{8}], face_index{8});
+  EXPECT_EQ(remap.faces[face_index{11}], face_index{11});
+  EXPECT_EQ(ids[face_index{7}], fi.get());
+  EXPECT_EQ(mesh.fracture(fracture_index{0}).num_faces(), 8);
+  EXPECT_EQ(mesh.fracture(k).num_faces(), 3);
+  EXPECT_EQ(mesh.fracture(fracture_index{2}).num_faces(), 1);
+  for (std::size_t i = 0; i < 3; ++i) {
+    const fracture_index kk{i};
+    for (auto&& fj : mesh.fracture(kk).faces())
+      EXPECT_EQ(mesh.face_fracture(fj), kk);
+  }
+  EXPECT_TRUE(validate(mesh).empty());
+
+  // Rolled back faces are removed from the range of their fracture.
+  mesh.set_current_fracture(k);
+  mesh.checkpoint();
+  mesh.add_face(v7, vertex_index{8}, v11);
+  EXPECT_FALSE(mesh.are_fractures_contiguous());
+  mesh.rollback();
+  mesh.remove_invalid_entities();
+  EXPECT_EQ(mesh.fracture(k).num_faces(), 3);
+  EXPECT_EQ(mesh.num_faces(), 12);
+}
+
+template <typename Relations>
+void test_assign() {
+  using mesh_type = fracture_mesh<point, tri_face, std::allocator<point>,
+                                  Relations>;
+  mesh_type grid;
+  add_grid(grid, 2, 2);
+  std::vector<point> points;
+  for (auto&& vi : grid.vertices()) points.push_back(grid.vertex(vi));
+  std::vector<tri_face> faces;
+  for (auto&& fi : grid.faces()) faces.push_back(grid.face(fi));
+  // Fracture 1 is empty, and fracture 2 branches at the edges of vertex 4.
+  points.emplace_back(1.0, 0.0, 1.0);
+  points.emplace_back(1.0, 1.0, 1.0);
+  points.emplace_back(1.0, 2.0, 1.0);
+  const vertex_index v1{1}, v4{4}, v7{7}, v9{9}, v10{10}, v11{11};
+  faces.emplace_back(v1, v4, v10);
+  faces.emplace_back(v1, v10, v9);
+  faces.emplace_back(v4, v7, v11);
+  faces.emplace_back(v4, v11, v10);
+
+  mesh_type a;
+  a.track_changes(true);
+  for (auto&& p : points) a.add_vertex(p);
+  for (std::size_t i = 0; i < faces.size(); ++i) {
+    if (i == 8) a.set_current_fracture(fracture_index{2});
+    a.add_face(faces[i]);
+  }
+  mesh_type b;
+  b.track_changes(true);
+  b.assign(points, faces, {0, 8, 8, 12});
+
+  ASSERT_EQ(b.num_vertices(), a.num_vertices());
+  ASSERT_EQ(b.num_edges(), a.num_edges());
+  ASSERT_EQ(b.num_faces(), a.num_faces());
+  const auto same = [](auto&& r1, auto&& r2) {
+    return std::equal(r1.begin(), r1.end(), r2.begin(), r2.end());
+  };
+  a.build_caches();
+  b.build_caches();
+  for (auto&& vi : a.vertices()) {
+    EXPECT_TRUE(b.is_valid(vi));
+    EXPECT_TRUE(same(a.vertex_edges(vi), b.vertex_edges(vi))) << vi;
+    EXPECT_TRUE(same(a.vertex_vertices(vi), b.vertex_vertices(vi))) << vi;
+    EXPECT_TRUE(same(a.vertex_faces(vi), b.vertex_faces(vi))) << vi;
+  }
+  for (auto&& ei : a.edges()) {
+    EXPECT_EQ(a.edge(ei).first, b.edge(ei).first);
+    EXPECT_EQ(a.edge(ei).second, b.edge(ei).second);
+    EXPECT_TRUE(same(a.edge_faces(ei), b.edge_faces(ei))) << ei;
+  }
+  for (auto&& fi : a.faces()) {
+    EXPECT_TRUE(same(a.face_edges(fi), b.face_edges(fi))) << fi;
+    EXPECT_EQ(a.face_fracture(fi), b.face_fracture(fi));
+  }
+  EXPECT_EQ(b.num_fractures(), 3);
+  EXPECT_EQ(b.current_fracture(), fracture_index{2});
+  EXPECT_EQ(b.fracture(fracture_index{1}).num_faces(), 0);
+  EXPECT_EQ(b.fracture_intersections().size(), 1);
+
+  ASSERT_EQ(b.epoch(), a.epoch());
+  const auto ca = a.changes_since(0);
+  const auto cb = b.changes_since(0);
+  EXPECT_TRUE(std::equal(ca.begin(), ca.end(), cb.begin(), cb.end(),
+                         [](const mesh_change& x, const mesh_change& y) {
+                           return x.type == y.type && x.change == y.change &&
+                                  x.index == y.index;
+                         }));
+
+  EXPECT_THROW(b.assign(points, faces, {0, 12}), std::logic_error);
+  mesh_type c;
+  EXPECT_THROW(c.assign(points, faces, {0, 8}), std::invalid_argument);
+  EXPECT_THROW(c.assign(points, faces, {0, 9, 8, 12}), std::invalid_argument);
+  c.checkpoint();
+  EXPECT_THROW(c.assign(points, faces, {0, 12}), std::logic_error);
+}
+
+TEST(FmeshTest, Assign) {
+  test_assign<all_relations>();
+  test_assign<minimal_relations>();
+}
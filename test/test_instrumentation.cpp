@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_ENABLE_INSTRUMENTATION
+#define FMESH_ENABLE_INSTRUMENTATION
+#endif
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/instrumentation.hpp"
+#include "fmesh/parallel.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(InstrumentationTest, CountersAndMemory) {
+  fracture_mesh<point, tri_face> mesh;
+
+  std::vector<vertex_index> v;
+  v.push_back(mesh.add_vertex(0.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(0.0, 0.0, 1.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 1.0));
+  mesh.add_face(tri_face{v[0], v[1], v[2]});
+  mesh.add_face(tri_face{v[1], v[3], v[2]});
+  mesh.invalidate(face_index{0});
+
+  const auto c = mesh.counters();
+  EXPECT_EQ(c.vertex_insertions, 4);
+  EXPECT_EQ(c.face_insertions, 2);
+  EXPECT_EQ(c.edge_insertions, 5);
+  EXPECT_EQ(c.face_lookups, 2);
+  EXPECT_EQ(c.edge_lookups, 6);
+  EXPECT_EQ(c.invalidations, 1);
+  EXPECT_GT(c.reallocations, 0);
+
+  const auto memory = mesh.memory_usage();
+  ASSERT_EQ(memory.size(), 13);
+  EXPECT_EQ(memory[0].name, "vertices");
+  EXPECT_EQ(memory[0].size_bytes, 4 * sizeof(point));
+  EXPECT_GE(memory[0].capacity_bytes, memory[0].size_bytes);
+  EXPECT_EQ(memory[6].name, "edge_faces");
+  EXPECT_EQ(memory[6].heap_blocks, 1 + 5);
+
+  timer_registry::instance().reset();
+  mesh.remove_invalid_entities();
+  const auto timers = timer_registry::instance().records();
+  EXPECT_EQ(timers.at("fracture_mesh::remove_invalid_entities").count, 1);
+
+  std::ostringstream os;
+  write_json(os, c);
+  EXPECT_EQ(os.str().front(), '{');
+  EXPECT_NE(os.str().find("\"invalidations\":1"), std::string::npos);
+
+  mesh.reset_counters();
+  EXPECT_EQ(mesh.counters().face_insertions, 0);
+}
+
+TEST(InstrumentationTest, IncrementalCaches) {
+  fracture_mesh<point, tri_face, std::allocator<point>, minimal_relations>
+      mesh;
+  timer_registry::instance().reset();
+
+  // Queries interleaved with insertions build each cache only once.
+  mesh.add_vertex(0.0, 0.0, 0.0);
+  mesh.add_vertex(0.0, 1.0, 0.0);
+  for (std::size_t i = 1; i <= 20; ++i) {
+    const auto a = mesh.add_vertex(1.0 * i, 0.0, 0.0);
+    const auto b = mesh.add_vertex(1.0 * i, 1.0, 0.0);
+    const auto f = mesh.add_face(vertex_index{a.get() - 2}, a, b);
+    const auto g = mesh.add_face(vertex_index{a.get() - 2}, b,
+                                 vertex_index{b.get() - 2});
+    const auto fs = mesh.vertex_faces(b);
+    ASSERT_EQ(fs.size(), 2);
+    EXPECT_EQ(fs.begin()[0], f);
+    EXPECT_EQ(fs.begin()[1], g);
+    EXPECT_EQ(mesh.vertex_vertices(a).size(), 2);
+  }
+  const auto timers = timer_registry::instance().records();
+  EXPECT_EQ(timers.at("fracture_mesh::cache_vertex_faces").count, 1);
+  EXPECT_EQ(timers.at("fracture_mesh::cache_vertex_vertices").count, 1);
+}
+
+TEST(InstrumentationTest, ConcurrentQueries) {
+  fracture_mesh<point, tri_face> mesh;
+  for (int i = 0; i < 3; ++i) mesh.add_vertex(i, 0.0, 0.0);
+  mesh.add_vertex(0.0, 1.0, 0.0);
+  mesh.add_face(vertex_index{0}, vertex_index{1}, vertex_index{3});
+  mesh.reset_counters();
+
+  // Const queries count lookups without losing increments.
+  std::vector<int> queries(10000);
+  const undirected_edge e{vertex_index{0}, vertex_index{1}};
+  parallel_for(queries, [&mesh, &e](int) { static_cast<void>(mesh.find(e)); });
+  EXPECT_EQ(mesh.counters().edge_lookups, queries.size());
+}
@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "fmesh/circulator.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/k_ring.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+using mesh_type = fracture_mesh<point, quad_face>;
+
+TEST(CirculatorTest, SkipsInvalidEntities) {
+  auto mesh = make_grid<mesh_type>(2, xz_plane{});
+  const vertex_index center{4};
+
+  EXPECT_EQ(faces_around(mesh, center).size(), 4);
+  EXPECT_EQ(edges_around(mesh, center).size(), 4);
+  EXPECT_EQ(adjacent_vertices(mesh, center).size(), 4);
+  EXPECT_EQ(adjacent_faces(mesh, face_index{0}).size(), 2);
+
+  mesh.invalidate(face_index{3});
+  EXPECT_EQ(faces_around(mesh, center).size(), 3);
+  EXPECT_EQ(adjacent_faces(mesh, face_index{1}).size(), 1);
+  EXPECT_EQ(*adjacent_faces(mesh, face_index{1}).begin(), face_index{0});
+  for (auto&& ei : mesh.face_edges(face_index{3}))
+    EXPECT_EQ(faces_around(mesh, ei).size(), mesh.is_valid(ei) ? 1 : 0);
+}
+
+TEST(KRingTest, VertexAndFaceRings) {
+  const auto mesh = make_grid<mesh_type>(4, xz_plane{});
+
+  vertex_ring vring;
+  k_ring(mesh, vertex_index{12}, 2, vring);
+  ASSERT_EQ(vring.num_rings(), 3);
+  EXPECT_EQ(vring.ring(0).size(), 1);
+  EXPECT_EQ(vring.ring(1).size(), 4);
+  EXPECT_EQ(vring.ring(2).size(), 8);
+
+  const auto capacity = vring.indices().capacity();
+  k_ring(mesh, vertex_index{0}, 2, vring);
+  EXPECT_EQ(vring.size(), 6);
+  EXPECT_EQ(vring.indices().capacity(), capacity);
+
+  face_ring fring;
+  k_ring(mesh, face_index{0}, 3, fring);
+  EXPECT_EQ(fring.ring(1).size(), 2);
+  EXPECT_EQ(fring.ring(2).size(), 3);
+  EXPECT_EQ(fring.ring(3).size(), 4);
+}
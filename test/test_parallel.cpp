@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/parallel.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(ParallelTest, ForEachFace) {
+  fracture_mesh<point, tri_face> mesh;
+  add_grid(mesh, 20, 20);
+  for (std::size_t k = 0; k < mesh.num_faces(); k += 3)
+    mesh.invalidate(face_index{k});
+
+  face_property<int> visits(mesh.num_faces());
+  parallel_for(mesh.faces(), [&visits](face_index fi) { ++visits[fi]; });
+  for (auto&& fi : mesh.faces()) EXPECT_EQ(visits[fi], 1);
+
+  std::atomic<std::size_t> num_valid{0};
+  parallel_for_valid(mesh, mesh.faces(), [&](face_index fi) {
+    EXPECT_TRUE(mesh.is_valid(fi));
+    ++num_valid;
+  });
+  std::size_t expected = 0;
+  for (auto&& fi : mesh.faces()) expected += mesh.is_valid(fi);
+  EXPECT_EQ(num_valid, expected);
+
+  const auto count = parallel_reduce(
+      mesh.faces(), std::size_t{0},
+      [&mesh](face_index fi) -> std::size_t { return mesh.is_valid(fi); },
+      [](std::size_t a, std::size_t b) { return a + b; }, 64);
+  EXPECT_EQ(count, expected);
+}
+
+TEST(ParallelTest, Pools) {
+  std::vector<double> values(10000);
+  std::iota(values.begin(), values.end(), 0.0);
+  const auto sum = [](double a, double b) { return a + b; };
+  const auto identity = [](double x) { return x; };
+
+  for (std::size_t num_threads : {0, 1, 4}) {
+    thread_pool pool{num_threads};
+    EXPECT_EQ(pool.num_threads(), num_threads);
+
+    // Nested loops are run by waiting threads as well.
+    std::vector<std::atomic<int>> counts(100);
+    parallel_for(
+        pool, counts,
+        [&pool](std::atomic<int>& c) {
+          std::vector<int> inner(10);
+          parallel_for(pool, inner, [&c](int) { ++c; }, 1);
+        },
+        1);
+    for (auto&& c : counts) EXPECT_EQ(c, 10);
+
+#ifndef FMESH_HAS_STD_EXECUTION
+    EXPECT_THROW(parallel_for(
+                     pool, values,
+                     [](double x) {
+                       if (x == 5000.0) throw std::runtime_error{"error"};
+                     },
+                     16),
+                 std::runtime_error);
+    // The first element is processed by the calling thread, which must still
+    // wait for the tasks it has submitted.
+    EXPECT_THROW(parallel_for(
+                     pool, values,
+                     [](double x) {
+                       if (x == 0.0) throw std::runtime_error{"error"};
+                     },
+                     16),
+                 std::runtime_error);
+#endif
+  }
+
+  // Results do not depend on the number of threads.
+  EXPECT_EQ(parallel_reduce(values, 0.0, identity, sum, 100),
+            std::accumulate(values.begin(), values.end(), 0.0));
+  EXPECT_EQ(parallel_reduce(std::vector<double>{}, 1.0, identity, sum), 1.0);
+}
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/partition.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+using mesh_type = fracture_mesh<point, quad_face>;
+
+TEST(PartitionTest, RecursiveCoordinateBisection) {
+  const auto mesh = make_grid<mesh_type>(8, xz_plane{});
+  const auto parts = partition_faces(mesh, 3);
+
+  std::vector<std::size_t> sizes(3, 0);
+  for (auto&& fi : mesh.faces()) ++sizes[parts[fi]];
+  EXPECT_EQ(sizes[0], 21);
+  EXPECT_EQ(sizes[1], 21);
+  EXPECT_EQ(sizes[2], 22);
+}
+
+TEST(PartitionTest, HaloExchange) {
+  const auto mesh = make_grid<mesh_type>(8, xz_plane{});
+  const auto subs = decompose(mesh, 4, 2);
+  ASSERT_EQ(subs.size(), 4);
+
+  std::size_t num_owned = 0;
+  for (auto&& sub : subs) {
+    num_owned += sub.num_owned_faces;
+    EXPECT_GT(sub.mesh.num_faces(), sub.num_owned_faces);
+    for (auto&& fi : sub.mesh.faces()) {
+      const auto gi = sub.global_faces[fi];
+      EXPECT_EQ(sub.to_local(gi), fi);
+      for (std::size_t k = 0; k < 4; ++k)
+        EXPECT_EQ(sub.global_vertices[sub.mesh.face(fi)[k]], mesh.face(gi)[k]);
+    }
+    for (auto&& ei : sub.mesh.edges())
+      EXPECT_TRUE(sub.global_edges[ei].is_valid());
+  }
+  EXPECT_EQ(num_owned, mesh.num_faces());
+
+  // Simulate ranks: owned entries hold global indices, ghosts are unknown.
+  std::vector<face_property<std::size_t>> face_values;
+  std::vector<vertex_property<std::size_t>> vertex_values;
+  std::vector<edge_property<std::size_t>> edge_values;
+  for (auto&& sub : subs) {
+    face_values.emplace_back(sub.mesh.num_faces());
+    for (auto&& fi : sub.mesh.faces())
+      face_values.back()[fi] = sub.is_owned(fi) ? sub.global_faces[fi].get() : 0;
+    vertex_values.emplace_back(sub.mesh.num_vertices());
+    for (auto&& vi : sub.mesh.vertices())
+      vertex_values.back()[vi] =
+          sub.is_owned(vi) ? sub.global_vertices[vi].get() : 0;
+    edge_values.emplace_back(sub.mesh.num_edges());
+    for (auto&& ei : sub.mesh.edges())
+      edge_values.back()[ei] =
+          sub.is_owned(ei) ? sub.global_edges[ei].get() : 0;
+  }
+
+  for (auto&& sub : subs) {
+    for (auto&& x : sub.halo) {
+      const auto& other = subs[x.neighbor];
+      const auto it = std::find_if(
+          other.halo.begin(), other.halo.end(),
+          [&sub](const auto& y) { return y.neighbor == sub.part; });
+      ASSERT_NE(it, other.halo.end());
+      ASSERT_EQ(x.send_faces.size(), it->recv_faces.size());
+      ASSERT_EQ(x.send_vertices.size(), it->recv_vertices.size());
+      for (std::size_t i = 0; i < x.send_faces.size(); ++i)
+        face_values[other.part][it->recv_faces[i]] =
+            face_values[sub.part][x.send_faces[i]];
+      for (std::size_t i = 0; i < x.send_vertices.size(); ++i)
+        vertex_values[other.part][it->recv_vertices[i]] =
+            vertex_values[sub.part][x.send_vertices[i]];
+      ASSERT_EQ(x.send_edges.size(), it->recv_edges.size());
+      for (std::size_t i = 0; i < x.send_edges.size(); ++i)
+        edge_values[other.part][it->recv_edges[i]] =
+            edge_values[sub.part][x.send_edges[i]];
+    }
+  }
+
+  for (auto&& sub : subs) {
+    for (auto&& fi : sub.mesh.faces())
+      EXPECT_EQ(face_values[sub.part][fi], sub.global_faces[fi].get());
+    for (auto&& vi : sub.mesh.vertices())
+      EXPECT_EQ(vertex_values[sub.part][vi], sub.global_vertices[vi].get());
+    for (auto&& ei : sub.mesh.edges())
+      EXPECT_EQ(edge_values[sub.part][ei], sub.global_edges[ei].get());
+  }
+}
+
+TEST(PartitionTest, InvalidPartIds) {
+  const auto mesh = make_grid<mesh_type>(4, xz_plane{});
+  auto parts = partition_faces(mesh, 2);
+  parts[face_index{3}] = 2;
+  EXPECT_THROW(decompose(mesh, parts, 2), std::invalid_argument);
+  parts[face_index{3}] = invalid_part;
+  EXPECT_EQ(decompose(mesh, parts, 2).size(), 2);
+  parts.resize(mesh.num_faces() - 1);
+  EXPECT_THROW(decompose(mesh, parts, 2), std::invalid_argument);
+}
@@ -0,0 +1,62 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/property_array.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(PropertyArrayTest, GatherAndScatterAdd) {
+  fracture_mesh<point, tri_face> mesh;
+  const auto v0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto v1 = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto v2 = mesh.add_vertex(0.0, 1.0, 0.0);
+  const auto v3 = mesh.add_vertex(1.0, 1.0, 0.0);
+  const auto f0 = mesh.add_face(v0, v1, v2);
+  const auto f1 = mesh.add_face(v1, v3, v2);
+
+  vertex_property<double> pressure{1.0, 2.0, 3.0, 4.0};
+  std::vector<double> corners(6);
+  auto it = gather(pressure, mesh.face(f0), corners.begin());
+  it = gather(pressure, mesh.face(f1), it);
+  EXPECT_EQ(it, corners.end());
+  EXPECT_EQ(corners, (std::vector<double>{1.0, 2.0, 3.0, 2.0, 4.0, 3.0}));
+
+  // Shared vertices receive contributions from both faces.
+  vertex_property<double> sums(mesh.num_vertices());
+  const std::vector<double> third{1.0, 1.0, 1.0};
+  scatter_add(sums, mesh.face(f0), third);
+  scatter_add(sums, mesh.face(f1), third);
+  EXPECT_EQ(sums[v0], 1.0);
+  EXPECT_EQ(sums[v1], 2.0);
+  EXPECT_EQ(sums[v2], 2.0);
+  EXPECT_EQ(sums[v3], 1.0);
+
+  const std::vector<vertex_index> repeated{v0, v0, v3};
+  scatter_add(sums, repeated, std::vector<double>{0.5, 0.25, 1.0});
+  EXPECT_EQ(sums[v0], 1.75);
+  EXPECT_EQ(sums[v3], 2.0);
+}
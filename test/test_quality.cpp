@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/quality.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(QualityTest, IdealAndPoorFaces) {
+  fracture_mesh<point, tri_face> mesh;
+  const auto v0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto v1 = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto v2 = mesh.add_vertex(0.5, std::sqrt(3.0) / 2.0, 0.0);
+  const auto v3 = mesh.add_vertex(0.5, -0.1, 0.0);
+  const auto v4 = mesh.add_vertex(0.5, 0.0, 1.0);
+  const auto f0 = mesh.add_face(v0, v1, v2);
+  const auto f1 = mesh.add_face(v0, v3, v1);
+  const auto f2 = mesh.add_face(v0, v1, v4);
+  mesh.invalidate(f2);
+
+  quality_options options;
+  options.num_worst = 1;
+  const auto report = compute_quality(mesh, options);
+
+  EXPECT_NEAR(report.aspect_ratios[f0], 1.0, 1e-12);
+  EXPECT_NEAR(report.min_angles[f0], 60.0, 1e-12);
+  EXPECT_NEAR(report.edge_ratios[f0], 1.0, 1e-12);
+  EXPECT_NEAR(report.skewness[f0], 0.0, 1e-12);
+
+  EXPECT_GT(report.aspect_ratios[f1], 5.0);
+  const auto pi = std::acos(-1.0);
+  EXPECT_NEAR(report.min_angles[f1], std::atan(0.2) * 180.0 / pi, 1e-9);
+  EXPECT_GT(report.skewness[f1], 0.8);
+  EXPECT_TRUE(std::isnan(report.skewness[f2]));
+
+  for (std::size_t m = 0; m < num_quality_metrics; ++m) {
+    const auto& s = report.summaries[m];
+    ASSERT_EQ(s.worst.size(), 1);
+    EXPECT_EQ(s.worst[0], f1);
+    ASSERT_EQ(s.histogram.size(), 10);
+    EXPECT_EQ(std::accumulate(s.histogram.begin(), s.histogram.end(),
+                              std::size_t{0}),
+              2);
+  }
+  const auto& angles = report.summary(quality_metric::min_angle);
+  EXPECT_NEAR(angles.max, 60.0, 1e-12);
+  EXPECT_EQ(angles.histogram[6], 1);
+  EXPECT_EQ(report.summary(quality_metric::aspect_ratio).histogram[0], 1);
+  EXPECT_EQ(report.summary(quality_metric::aspect_ratio).histogram[9], 1);
+}
+
+TEST(QualityTest, LargeQuadMesh) {
+  fracture_mesh<point, quad_face> mesh;
+  const std::size_t n = 100;
+  add_grid(mesh, n, n, [n](std::size_t i, std::size_t j) {
+    const auto dx = 0.3 * std::sin(0.7 * i + 1.3 * j);
+    const auto dy = 0.3 * std::cos(1.1 * i - 0.4 * j);
+    const bool interior = i > 0 && i < n && j > 0 && j < n;
+    return point{i + (interior ? dx : 0.0), j + (interior ? dy : 0.0), 0.0};
+  });
+  mesh.invalidate(face_index{5000});
+
+  quality_options options;
+  options.num_worst = 5;
+  const auto report = compute_quality(mesh, options);
+
+  // Worst faces agree with sorting all faces.
+  std::vector<face_index> faces;
+  for (auto&& fi : mesh.faces())
+    if (mesh.is_valid(fi)) faces.push_back(fi);
+  std::sort(faces.begin(), faces.end(), [&report](auto a, auto b) {
+    const auto& s = report.skewness;
+    return s[a] != s[b] ? s[a] > s[b] : a < b;
+  });
+  faces.resize(5);
+  const auto& skew = report.summary(quality_metric::skewness);
+  EXPECT_EQ(skew.worst, faces);
+
+  double sum = 0.0;
+  for (auto&& fi : mesh.faces())
+    if (mesh.is_valid(fi)) sum += report.skewness[fi];
+  EXPECT_NEAR(skew.mean, sum / (n * n - 1), 1e-12);
+  EXPECT_EQ(skew.max, report.skewness[faces[0]]);
+  EXPECT_EQ(std::accumulate(skew.histogram.begin(), skew.histogram.end(),
+                            std::size_t{0}),
+            n * n - 1);
+
+  // Arrays are reused.
+  quality_report reused = report;
+  compute_quality(mesh, reused, options);
+  EXPECT_EQ(reused.summary(quality_metric::min_angle).worst,
+            report.summary(quality_metric::min_angle).worst);
+}
@@ -0,0 +1,144 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/refinement.hpp"
+#include "fmesh/validation.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+template <typename Mesh>
+std::size_t count_valid_faces(const Mesh& mesh) {
+  return std::count_if(mesh.face_begin(), mesh.face_end(),
+                       [&mesh](auto fi) { return mesh.is_valid(fi); });
+}
+
+TEST(RefinementTest, TriangleRedGreen) {
+  fracture_mesh<point, tri_face> mesh;
+
+  std::vector<vertex_index> v;
+  v.push_back(mesh.add_vertex(0.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(0.0, 0.0, 1.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 1.0));
+  // Branch sharing the edge (1, 2)
+  v.push_back(mesh.add_vertex(0.5, 1.0, 0.5));
+
+  std::vector<face_index> f;
+  f.push_back(mesh.add_face(v[0], v[1], v[2]));
+  f.push_back(mesh.add_face(v[1], v[3], v[2]));
+  f.push_back(mesh.add_face(v[1], v[4], v[2]));
+
+  vertex_property<double> pressure{1.0, 2.0, 3.0, 4.0, 5.0};
+  face_property<int> tag{10, 20, 30};
+
+  const auto result = refine(
+      mesh, {f[0]},
+      [&](vertex_index vi, const auto& parents) {
+        pressure.resize(mesh.num_vertices());
+        double sum = 0.0;
+        for (auto&& p : parents) sum += pressure[p];
+        pressure[vi] = sum / parents.size();
+      },
+      [&](face_index child, face_index parent) {
+        tag.resize(mesh.num_faces());
+        tag[child] = tag[parent];
+      });
+
+  // 3 midpoints, 4 red children, 2 + 2 green children at the branching edge
+  EXPECT_EQ(result.new_vertices.size(), 3);
+  EXPECT_EQ(result.new_faces.size(), 8);
+  EXPECT_EQ(result.refined_faces.size(), 3);
+  EXPECT_EQ(count_valid_faces(mesh), 8);
+  for (auto&& fi : f) EXPECT_FALSE(mesh.is_valid(fi));
+
+  const auto e12 = mesh.find(undirected_edge{v[1], v[2]});
+  EXPECT_FALSE(mesh.is_valid(e12));
+
+  const auto& m = mesh.vertex(result.new_vertices[0]);
+  EXPECT_DOUBLE_EQ(m.x + m.y + m.z, 0.5);
+  for (auto&& vi : result.new_vertices) {
+    const auto& p = mesh.vertex(vi);
+    if (p.x == 0.5 && p.z == 0.5) {
+      EXPECT_DOUBLE_EQ(pressure[vi], 2.5);
+    }
+  }
+  EXPECT_EQ(tag[result.new_faces.back()], 30);
+}
+
+TEST(RefinementTest, QuadSheet) {
+  fracture_mesh<point, quad_face> mesh;
+
+  // 3 x 1 strip of quads
+  std::vector<vertex_index> v;
+  for (int i = 0; i < 4; ++i) v.push_back(mesh.add_vertex(i, 0.0, 0.0));
+  for (int i = 0; i < 4; ++i) v.push_back(mesh.add_vertex(i, 0.0, 1.0));
+
+  std::vector<face_index> f;
+  for (int i = 0; i < 3; ++i)
+    f.push_back(mesh.add_face(v[i], v[i + 1], v[i + 5], v[i + 4]));
+
+  const auto result = refine(mesh, {f[0]});
+
+  // 4 children in the marked face and 2 in each of the others.
+  EXPECT_EQ(result.new_faces.size(), 8);
+  EXPECT_EQ(count_valid_faces(mesh), 8);
+  // 4 edge midpoints and 1 center in the first face, 2 more midpoints.
+  EXPECT_EQ(result.new_vertices.size(), 7);
+}
+
+TEST(RefinementTest, UniformRefinementOfLargeGrids) {
+  const int n = 40;
+  auto tris = make_grid<fracture_mesh<point, tri_face>>(n);
+  auto quads = make_grid<fracture_mesh<point, quad_face>>(n);
+
+  const auto check = [n](auto& mesh) {
+    std::vector<face_index> all(mesh.face_begin(), mesh.face_end());
+    std::size_t num_parents = 0;
+    const auto result = refine(
+        mesh, all,
+        [&](vertex_index vi, const auto& parents) {
+          // New vertices are averages of their parents.
+          double x = 0.0;
+          for (auto&& p : parents) x += mesh.vertex(p).x;
+          EXPECT_DOUBLE_EQ(mesh.vertex(vi).x, x / parents.size());
+          num_parents += parents.size();
+        },
+        [](face_index, face_index) {});
+    EXPECT_EQ(mesh.num_vertices(), (2 * n + 1) * (2 * n + 1));
+    EXPECT_EQ(count_valid_faces(mesh), 4 * all.size());
+    EXPECT_EQ(result.new_faces.size(), 4 * all.size());
+    EXPECT_EQ(result.new_vertices.size(),
+              mesh.num_vertices() - (n + 1) * (n + 1));
+    mesh.remove_invalid_entities();
+    EXPECT_TRUE(validate(mesh).empty());
+    return num_parents;
+  };
+  // Quadrilateral centers have four parents.
+  EXPECT_EQ(check(tris), 2 * (3 * n * n + 2 * n));
+  EXPECT_EQ(check(quads), 2 * (2 * n * n + 2 * n) + 4 * n * n);
+}
@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/sparsity.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(SparsityTest, BranchingMesh) {
+  fracture_mesh<point, tri_face> mesh;
+
+  std::vector<vertex_index> v;
+  v.push_back(mesh.add_vertex(0.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 0.0));
+  v.push_back(mesh.add_vertex(0.0, 0.0, 1.0));
+  v.push_back(mesh.add_vertex(1.0, 0.0, 1.0));
+  v.push_back(mesh.add_vertex(0.5, 1.0, 0.5));
+
+  // Three faces sharing the edge (1, 2)
+  mesh.add_face(v[0], v[1], v[2]);
+  mesh.add_face(v[1], v[3], v[2]);
+  mesh.add_face(v[1], v[4], v[2]);
+
+  const auto ff = face_face_pattern<int>(mesh);
+  EXPECT_EQ(ff.num_rows(), 3);
+  EXPECT_EQ(ff.num_nonzeros(), 9);
+  EXPECT_EQ(ff.row_offsets, (std::vector<int>{0, 3, 6, 9}));
+
+  const auto vv = vertex_vertex_pattern(mesh);
+  EXPECT_EQ(vv.num_rows(), 5);
+  EXPECT_EQ(vv.row_offsets,
+            (std::vector<std::size_t>{0, 3, 8, 13, 16, 19}));
+  EXPECT_EQ(std::vector<std::size_t>(vv.columns.begin() + 3,
+                                     vv.columns.begin() + 8),
+            (std::vector<std::size_t>{0, 1, 2, 3, 4}));
+
+  mesh.invalidate(face_index{1});
+  const auto vf = vertex_face_pattern(mesh);
+  EXPECT_EQ(vf.num_columns, 3);
+  EXPECT_EQ(vf.row_offsets, (std::vector<std::size_t>{0, 1, 3, 5, 5, 6}));
+  EXPECT_EQ(vf.columns, (std::vector<std::size_t>{0, 0, 2, 0, 2, 2}));
+}
+
+TEST(SparsityTest, ParallelBuildMatchesSerial) {
+  // More rows than a task builds, so that several chunks are joined.
+  fracture_mesh<point, tri_face, std::allocator<point>, minimal_relations>
+      mesh;
+  add_grid(mesh, 50, 50);
+  mesh.invalidate(face_index{100});
+
+  std::vector<std::set<int>> rows(mesh.num_vertices());
+  for (auto&& fi : mesh.faces()) {
+    if (!mesh.is_valid(fi)) continue;
+    for (auto&& vi : mesh.face(fi))
+      for (auto&& vj : mesh.face(fi))
+        rows[vi.get()].insert(static_cast<int>(vj.get()));
+  }
+  std::vector<int> offsets = {0};
+  std::vector<int> columns;
+  for (auto&& row : rows) {
+    columns.insert(columns.end(), row.begin(), row.end());
+    offsets.push_back(static_cast<int>(columns.size()));
+  }
+
+  const auto vv = vertex_vertex_pattern<int>(mesh);
+  EXPECT_EQ(vv.row_offsets, offsets);
+  EXPECT_EQ(vv.columns, columns);
+}
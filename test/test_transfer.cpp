@@ -0,0 +1,169 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "fmesh/dfn.hpp"
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/geometry.hpp"
+#include "fmesh/transfer.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+namespace {
+
+/// Builds an n x n grid on [0, 1]^2
+template <typename Face>
+fracture_mesh<point, Face> unit_grid(int n) {
+  return make_grid<fracture_mesh<point, Face>>(
+      n, [n](std::size_t i, std::size_t j) {
+        return point{static_cast<double>(i) / n, static_cast<double>(j) / n,
+                     0.0};
+      });
+}
+
+}  // namespace
+
+TEST(TransferTest, ConservativeFaceTransfer) {
+  const auto source = unit_grid<quad_face>(2);
+  const auto target = unit_grid<tri_face>(3);
+  const face_property<double> values{1.0, 2.0, 3.0, 4.0};
+
+  const face_locator locator{source};
+  const auto result =
+      transfer(locator, values, target, transfer_method::conservative);
+  ASSERT_EQ(result.size(), target.num_faces());
+
+  double integral = 0.0;
+  for (auto&& fi : target.faces())
+    integral += norm(area_vector(target, target.face(fi))) * result[fi];
+  EXPECT_NEAR(integral, 0.25 * (1.0 + 2.0 + 3.0 + 4.0), 1e-12);
+
+  // The first triangle lies inside the first quad.
+  EXPECT_NEAR(result[face_index{0}], 1.0, 1e-12);
+  // The central cell overlaps all quads symmetrically.
+  EXPECT_NEAR(result[face_index{8}] + result[face_index{9}], 5.0, 1e-12);
+
+  const auto nearest =
+      transfer(locator, values, target, transfer_method::nearest);
+  EXPECT_EQ(nearest[face_index{0}], 1.0);
+  EXPECT_EQ(nearest[face_index{17}], 4.0);
+
+  EXPECT_THROW(transfer(locator, values, target, transfer_method::linear),
+               std::invalid_argument);
+}
+
+TEST(TransferTest, LinearVertexTransfer) {
+  const auto source = unit_grid<quad_face>(2);
+  auto target = unit_grid<tri_face>(3);
+  target.add_vertex(0.3, 0.6, 0.2);
+  target.add_vertex(1.5, 0.5, 0.0);
+
+  const auto f = [](double x, double y) { return 2.0 * x + 3.0 * y + 1.0; };
+  vertex_property<double> values(source.num_vertices());
+  for (auto&& vi : source.vertices())
+    values[vi] = f(source.vertex(vi).x, source.vertex(vi).y);
+
+  const face_locator locator{source};
+  const auto result =
+      transfer(locator, values, target, transfer_method::linear);
+  for (vertex_index vi{0}; vi < vertex_index{16}; ++vi)
+    EXPECT_NEAR(result[vi], f(target.vertex(vi).x, target.vertex(vi).y),
+                1e-12);
+  // Points off the mesh take values at their closest points.
+  EXPECT_NEAR(result[vertex_index{16}], f(0.3, 0.6), 1e-12);
+  EXPECT_NEAR(result[vertex_index{17}], f(1.0, 0.5), 1e-12);
+
+  const auto nearest =
+      transfer(locator, values, target, transfer_method::nearest);
+  EXPECT_EQ(nearest[vertex_index{17}], f(1.0, 0.5));
+  EXPECT_EQ(nearest[vertex_index{5}], f(0.5, 0.5));
+
+  EXPECT_THROW(
+      transfer(locator, values, target, transfer_method::conservative),
+      std::invalid_argument);
+}
+
+TEST(TransferTest, BranchesDoNotMix) {
+  // Fracture A on z = 0 and fracture B on x = 1 crossing it
+  const auto make = [](int n) {
+    fracture_mesh<point, quad_face> mesh;
+    const auto h = 1.0 / n;
+    const auto a = add_grid(mesh, 2 * n, n, [h](std::size_t i, std::size_t j) {
+      return point{i * h, j * h, 0.0};
+    });
+    std::vector<vertex_index> b;
+    for (int k = 0; k <= 2 * n; ++k)
+      for (int j = 0; j <= n; ++j)
+        b.push_back(k == n ? a[static_cast<std::size_t>(j * (2 * n + 1) + n)]
+                           : mesh.add_vertex(1.0, j * h, (k - n) * h));
+    add_grid_faces(mesh, b, n, 2 * n);
+    return mesh;
+  };
+  const auto source = make(1);
+  const auto target = make(4);
+
+  face_property<double> values(source.num_faces());
+  for (auto&& fi : source.faces()) {
+    const auto n = area_vector(source, source.face(fi));
+    values[fi] = std::abs(n.z) > 0.0 ? 1.0 : 2.0;
+  }
+
+  const face_locator locator{source};
+  const auto result =
+      transfer(locator, values, target, transfer_method::conservative);
+  for (auto&& fi : target.faces()) {
+    const auto n = area_vector(target, target.face(fi));
+    EXPECT_NEAR(result[fi], std::abs(n.z) > 0.0 ? 1.0 : 2.0, 1e-12);
+  }
+}
+
+TEST(TransferTest, ClosestPointMatchesBruteForce) {
+  fracture_mesh<point, tri_face> mesh;
+  dfn_parameters param;
+  param.seed = 3;
+  param.num_fractures = 12;
+  param.num_cells = 16;
+  generate_dfn(mesh, param);
+
+  const face_locator locator{mesh};
+  const face_locator brute_force{mesh, 1e3};
+  std::mt19937_64 engine{11};
+  std::uniform_real_distribution<double> uniform{-4.0, 20.0};
+  for (int n = 0; n < 200; ++n) {
+    const vector3 p{uniform(engine), uniform(engine), uniform(engine)};
+    const auto l = locator.closest_point(p);
+    const auto m = brute_force.closest_point(p);
+    ASSERT_TRUE(l.face.is_valid());
+    EXPECT_NEAR(l.distance, m.distance, 1e-12);
+  }
+
+  EXPECT_THROW(locator.closest_point({1e300, 0.0, 0.0}), std::invalid_argument);
+  EXPECT_THROW(locator.closest_point({std::nan(""), 0.0, 0.0}),
+               std::invalid_argument);
+  EXPECT_THROW((face_locator{mesh, 1e-300}), std::invalid_argument);
+}
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FMESH_TEST_UTIL_HPP
+#define FMESH_TEST_UTIL_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "fmesh/index.hpp"
+
+/// Point type of the meshes in tests
+struct point {
+  double x;
+  double y;
+  double z;
+
+  point() = default;
+  point(double tx, double ty, double tz) : x{tx}, y{ty}, z{tz} {}
+};
+
+/// Maps grid point (i, j) to (i, j, 0)
+struct xy_plane {
+  point operator()(std::size_t i, std::size_t j) const {
+    return {static_cast<double>(i), static_cast<double>(j), 0.0};
+  }
+};
+
+/// Maps grid point (i, j) to (i, 0, j)
+struct xz_plane {
+  point operator()(std::size_t i, std::size_t j) const {
+    return {static_cast<double>(i), 0.0, static_cast<double>(j)};
+  }
+};
+
+/// Adds faces of a grid of n x m cells from the vertices of its corners,
+/// given row by row. Each cell is a quadrilateral or two triangles split
+/// along the diagonal from corner (i, j) to (i + 1, j + 1).
+template <typename Mesh>
+void add_grid_faces(Mesh& mesh, const std::vector<fmesh::vertex_index>& vs,
+                    std::size_t n, std::size_t m) {
+  const auto id = [&vs, n](std::size_t i, std::size_t j) {
+    return vs[j * (n + 1) + i];
+  };
+  for (std::size_t j = 0; j < m; ++j) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if constexpr (Mesh::face_type::num_vertices == 3) {
+        mesh.add_face(id(i, j), id(i + 1, j), id(i + 1, j + 1));
+        mesh.add_face(id(i, j), id(i + 1, j + 1), id(i, j + 1));
+      } else {
+        mesh.add_face(id(i, j), id(i + 1, j), id(i + 1, j + 1), id(i, j + 1));
+      }
+    }
+  }
+}
+
+/// Adds a grid of n x m cells whose point (i, j) is map(i, j), and returns
+/// its vertices row by row
+template <typename Mesh, typename Map = xy_plane>
+std::vector<fmesh::vertex_index> add_grid(Mesh& mesh, std::size_t n,
+                                          std::size_t m, Map&& map = {}) {
+  std::vector<fmesh::vertex_index> vs;
+  for (std::size_t j = 0; j <= m; ++j)
+    for (std::size_t i = 0; i <= n; ++i)
+      vs.push_back(mesh.add_vertex(map(i, j)));
+  add_grid_faces(mesh, vs, n, m);
+  return vs;
+}
+
+/// Builds a mesh of a grid of n x n cells whose point (i, j) is map(i, j)
+template <typename Mesh, typename Map = xy_plane>
+Mesh make_grid(std::size_t n, Map&& map = {}) {
+  Mesh mesh;
+  add_grid(mesh, n, n, std::forward<Map>(map));
+  return mesh;
+}
+
+#endif  // FMESH_TEST_UTIL_HPP
@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/validation.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(ValidationTest, ConsistentMeshes) {
+  fracture_mesh<point, quad_face> mesh;
+  const int n = 3;
+  add_grid(mesh, n, n);
+  const auto id = [](int i, int j) {
+    return vertex_index{static_cast<std::size_t>(j * (n + 1) + i)};
+  };
+
+  // A branch along the middle column.
+  const auto a = mesh.add_vertex(1.0, 0.0, 1.0);
+  const auto b = mesh.add_vertex(1.0, 1.0, 1.0);
+  mesh.add_face(id(1, 0), id(1, 1), b, a);
+  EXPECT_TRUE(validate(mesh).empty());
+
+  mesh.invalidate(face_index{4});
+  mesh.invalidate(a);
+  EXPECT_TRUE(validate(mesh).empty());
+
+  mesh.remove_invalid_entities();
+  EXPECT_TRUE(validate(mesh).empty());
+}
+
+TEST(ValidationTest, ReportsIssues) {
+  fracture_mesh<point, tri_face> mesh;
+  std::vector<vertex_index> v;
+  for (int i = 0; i < 6; ++i) v.push_back(mesh.add_vertex(i, 0.0, 0.0));
+
+  // Two triangles touching at v[2] only.
+  mesh.add_face(v[0], v[1], v[2]);
+  mesh.add_face(v[2], v[3], v[4]);
+  // The same vertices in another orientation.
+  const auto f2 = mesh.add_face(v[0], v[2], v[1]);
+  ASSERT_TRUE(f2.is_valid());
+
+  const auto issues = validate(mesh);
+  ASSERT_EQ(issues.size(), 3u);
+
+  EXPECT_EQ(issues[0].kind, issue_kind::non_manifold_vertex);
+  EXPECT_EQ(issues[0].entity, entity_kind::vertex);
+  EXPECT_EQ(issues[0].index, 2u);
+
+  EXPECT_EQ(issues[1].kind, issue_kind::isolated_entity);
+  EXPECT_EQ(issues[1].entity, entity_kind::vertex);
+  EXPECT_EQ(issues[1].index, 5u);
+
+  EXPECT_EQ(issues[2].kind, issue_kind::duplicate_entity);
+  EXPECT_EQ(issues[2].entity, entity_kind::face);
+  EXPECT_EQ(issues[2].index, 2u);
+  EXPECT_EQ(issues[2].related_entity, entity_kind::face);
+  EXPECT_EQ(issues[2].related_index, 0u);
+
+  std::ostringstream ss;
+  ss << issues[2];
+  EXPECT_EQ(ss.str(), "duplicate_entity face 2 (face 0)");
+}
+
+TEST(ValidationTest, IssuesInIndexOrderAcrossChunks) {
+  fracture_mesh<point, tri_face, std::allocator<point>, minimal_relations>
+      mesh;
+  const int n = 60;
+  std::vector<vertex_index> grid;
+  std::vector<std::size_t> isolated;
+  for (int j = 0; j <= n; ++j) {
+    for (int i = 0; i <= n; ++i) {
+      grid.push_back(mesh.add_vertex(i, j, 0.0));
+      // Unused vertices scattered over several chunks
+      if ((j * (n + 1) + i) % 500 == 0)
+        isolated.push_back(mesh.add_vertex(i, j, 1.0).get());
+    }
+  }
+  add_grid_faces(mesh, grid, n, n);
+  const auto id = [&grid](int i, int j) { return grid[j * (n + 1) + i]; };
+  const auto f = mesh.add_face(id(n, n), id(n - 1, n - 1), id(n, n - 1));
+  ASSERT_TRUE(f.is_valid());
+
+  const auto issues = validate(mesh);
+  ASSERT_EQ(issues.size(), isolated.size() + 1);
+  for (std::size_t k = 0; k < isolated.size(); ++k) {
+    EXPECT_EQ(issues[k].kind, issue_kind::isolated_entity);
+    EXPECT_EQ(issues[k].entity, entity_kind::vertex);
+    EXPECT_EQ(issues[k].index, isolated[k]);
+  }
+  EXPECT_EQ(issues.back().kind, issue_kind::duplicate_entity);
+  EXPECT_EQ(issues.back().index, f.get());
+}
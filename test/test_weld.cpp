@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright (c) 2019 Sho Hirose (sho.hirose@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "fmesh/fixed_size_face.hpp"
+#include "fmesh/fracture_mesh.hpp"
+#include "fmesh/validation.hpp"
+#include "fmesh/weld.hpp"
+#include "test_util.hpp"
+
+using namespace fmesh;
+
+TEST(WeldTest, JoinsIndependentFractures) {
+  fracture_mesh<point, quad_face> mesh;
+
+  // Fracture A on z = 0
+  std::vector<vertex_index> a;
+  for (int j = 0; j < 2; ++j)
+    for (int i = 0; i < 3; ++i) a.push_back(mesh.add_vertex(i, j, 0.0));
+  mesh.add_face(a[0], a[1], a[4], a[3]);
+  mesh.add_face(a[1], a[2], a[5], a[4]);
+
+  // Fracture B on x = 1 crossing A at a[1]-a[4]
+  const auto b0 = mesh.add_vertex(1.0 + 1e-9, 0.0, 0.0);
+  const auto b1 = mesh.add_vertex(1.0, 1.0 - 1e-9, 0.0);
+  const auto b2 = mesh.add_vertex(1.0, 1.0, 1.0);
+  const auto b3 = mesh.add_vertex(1.0, 0.0, 1.0);
+  mesh.add_face(b0, b1, b2, b3);
+
+  // A copy of the first face of A in reverse orientation
+  const auto c0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto c1 = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto c3 = mesh.add_vertex(0.0, 1.0, 0.0);
+  const auto c4 = mesh.add_vertex(1.0, 1.0, 0.0);
+  mesh.add_face(c0, c3, c4, c1);
+
+  const auto result = weld_vertices(mesh, 1e-6);
+  EXPECT_EQ(result.num_merged_vertices, 6u);
+  EXPECT_EQ(result.num_removed_faces, 1u);
+  EXPECT_EQ(mesh.num_vertices(), 8u);
+  EXPECT_EQ(mesh.num_faces(), 3u);
+  EXPECT_EQ(mesh.num_edges(), 10u);
+  EXPECT_TRUE(validate(mesh).empty());
+
+  const auto& remap = result.remap;
+  EXPECT_EQ(remap.vertices[b0], remap.vertices[a[1]]);
+  EXPECT_EQ(remap.vertices[b1], remap.vertices[a[4]]);
+  EXPECT_EQ(remap.vertices[c3], remap.vertices[a[3]]);
+  EXPECT_EQ(remap.faces[face_index{3}], remap.faces[face_index{0}]);
+
+  // The intersection is a branching edge.
+  const auto ei = mesh.find(
+      undirected_edge{remap.vertices[a[1]], remap.vertices[a[4]]});
+  ASSERT_TRUE(ei.is_valid());
+  EXPECT_EQ(mesh.edge_faces(ei).size(), 3u);
+  EXPECT_EQ(remap.edges[edge_index{1}], ei);
+  EXPECT_EQ(remap.edges[edge_index{7}], ei);
+
+  EXPECT_THROW(weld_vertices(mesh, 0.0), std::invalid_argument);
+
+  // Cell indices would overflow, so nothing is welded.
+  const auto nv = mesh.num_vertices();
+  mesh.add_vertex(1e300, 0.0, 0.0);
+  EXPECT_THROW(weld_vertices(mesh, 1e-3), std::invalid_argument);
+  EXPECT_EQ(mesh.num_vertices(), nv + 1);
+}
+
+TEST(WeldTest, RemovesCollapsedFaces) {
+  fracture_mesh<point, tri_face> mesh;
+  const auto v0 = mesh.add_vertex(0.0, 0.0, 0.0);
+  const auto v1 = mesh.add_vertex(1.0, 0.0, 0.0);
+  const auto v2 = mesh.add_vertex(0.0, 1.0, 0.0);
+  const auto v3 = mesh.add_vertex(1.0, 1e-3, 0.0);
+  mesh.add_face(v0, v1, v2);
+  mesh.add_face(v1, v3, v2);
+
+  const auto result = weld_vertices(mesh, 1e-2);
+  EXPECT_EQ(result.num_merged_vertices, 1u);
+  EXPECT_EQ(result.num_removed_faces, 1u);
+  EXPECT_EQ(mesh.num_vertices(), 3u);
+  EXPECT_EQ(mesh.num_faces(), 1u);
+  EXPECT_EQ(result.remap.vertices[v3], vertex_index{1});
+  EXPECT_FALSE(result.remap.faces[face_index{1}].is_valid());
+  EXPECT_TRUE(validate(mesh).empty());
+}
+
+TEST(WeldTest, ParallelClustersMatchBruteForce) {
+  fracture_mesh<point, tri_face> mesh;
+  std::mt19937_64 engine{5};
+  std::uniform_real_distribution<double> uniform{0.0, 10.0};
+  std::uniform_real_distribution<double> jitter{-0.01, 0.01};
+  std::vector<point> points;
+  for (int n = 0; n < 800; ++n) {
+    const point p{uniform(engine), uniform(engine), uniform(engine)};
+    for (int k = 0; k < 3; ++k) {
+      points.emplace_back(p.x + jitter(engine), p.y + jitter(engine),
+                          p.z + jitter(engine));
+    }
+  }
+  std::shuffle(points.begin(), points.end(), engine);
+  for (auto&& p : points) mesh.add_vertex(p.x, p.y, p.z);
+
+  // Serial union-find over all pairs
+  const double tolerance = 0.05;
+  std::vector<std::size_t> roots(points.size());
+  for (std::size_t i = 0; i < roots.size(); ++i) roots[i] = i;
+  const auto find = [&roots](std::size_t i) {
+    while (roots[i] != i) i = roots[i] = roots[roots[i]];
+    return i;
+  };
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    for (std::size_t j = i + 1; j < points.size(); ++j) {
+      const auto dx = points[i].x - points[j].x;
+      const auto dy = points[i].y - points[j].y;
+      const auto dz = points[i].z - points[j].z;
+      if (std::sqrt(dx * dx + dy * dy + dz * dz) > tolerance) continue;
+      const auto ri = find(i);
+      const auto rj = find(j);
+      roots[std::max(ri, rj)] = std::min(ri, rj);
+    }
+  }
+
+  const auto result = weld_vertices(mesh, tolerance);
+  std::size_t num_merged = 0;
+  std::vector<vertex_index> kept(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (find(i) != i) {
+      ++num_merged;
+      continue;
+    }
+    kept[i] = vertex_index{i - num_merged};
+  }
+  EXPECT_EQ(result.num_merged_vertices, num_merged);
+  EXPECT_EQ(mesh.num_vertices(), points.size() - num_merged);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(result.remap.vertices[vertex_index{i}], kept[find(i)]);
+  }
+}